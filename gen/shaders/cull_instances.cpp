@@ -0,0 +1,95 @@
+#include "cull_instances.h"
+#include <memory>
+namespace pipelines { namespace cull_instances {
+const char* COMPUTE_SHADER = R""(
+#version 430
+#extension GL_ARB_shading_language_include : enable
+
+layout(local_size_x = 64)in;
+
+struct Instance {
+    mat4 modelMatrix;
+};
+
+
+struct AffineInstance {
+    vec4 row0;
+    vec4 row1;
+    vec4 row2;
+};
+
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std140, binding = 0)uniform CullingBlock {
+    vec4 frustumPlanes[6];
+
+    vec4 boundsCenter;
+    vec4 boundsExtent;
+    uint numInstances;
+};
+
+layout(std430, binding = 0)readonly buffer AllInstances {
+    Instance allInstances[];
+};
+
+layout(std430, binding = 1)writeonly buffer VisibleInstances {
+    AffineInstance visibleInstances[];
+};
+
+
+layout(std430, binding = 2)buffer DrawCommands {
+    DrawCommand drawCommands[];
+};
+
+void main(void){
+    uint index = gl_GlobalInvocationID . x;
+    if(index >= numInstances){
+        return;
+    }
+    Instance instance = allInstances[index];
+
+
+    mat4 m = instance . modelMatrix;
+    vec3 center =(m * vec4(boundsCenter . xyz, 1.0)). xyz;
+    vec3 extent = abs(m[0]. xyz)* boundsExtent . x + abs(m[1]. xyz)* boundsExtent . y + abs(m[2]. xyz)* boundsExtent . z;
+    for(int i = 0;i < 6;i ++){
+        vec3 normal = frustumPlanes[i]. xyz;
+        if(dot(normal, center)+ frustumPlanes[i]. w + dot(abs(normal), extent)< 0.0){
+            return;
+        }
+    }
+
+
+    uint slot = atomicAdd(drawCommands[0]. instanceCount, 1u);
+    mat4 rows = transpose(m);
+    visibleInstances[drawCommands[0]. baseInstance + slot]= AffineInstance(rows[0], rows[1], rows[2]);
+}
+)"";
+string ComputeShader::getKey() const { return key; }
+shared_ptr<Shader> ComputeShader::build(OpenGLContext& context) {
+    return make_shared<Shader>(std::move(context.buildShader(ShaderType::COMPUTE, key, COMPUTE_SHADER)));
+}
+Shaders::Shaders(ShaderCache* cache) : cache(*cache) {}
+Shaders::Shaders(ShaderCache& cache) : cache(cache) {}
+ShaderStages Shaders::getStages() const {
+    return {
+    .compute = cache.get(ComputeShader {}),
+    };
+};
+void ResourceBindingPipelineState::bindAll(const ResourceBindings& bindings, OpenGLContext& context) {
+    context.bindUniformBuffer(bindings.cullingBlock.buffer, 0, bindings.cullingBlock.byteOffset, sizeof(CullingBlock));
+    context.bindStorageBuffer(bindings.allInstances.buffer, 0, bindings.allInstances.byteOffset, bindings.allInstances.getSize());
+    context.bindStorageBuffer(bindings.visibleInstances.buffer, 1, bindings.visibleInstances.byteOffset, bindings.visibleInstances.getSize());
+    context.bindStorageBuffer(bindings.drawCommands.buffer, 2, bindings.drawCommands.byteOffset, bindings.drawCommands.getSize());
+}
+ResourceBindingPipelineState ResourceBindingCreateInfo::init() {
+    return ResourceBindingPipelineState {};
+}
+}}
\ No newline at end of file
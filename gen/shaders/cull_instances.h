@@ -0,0 +1,66 @@
+#pragma once
+// autogenerated from GLSL, do not edit
+#include <glm/glm.hpp>
+#include "../../src/graphics/OpenGLContext.h"
+#include "../../src/graphics/commands.h"
+#include "../../src/graphics/Shader.h"
+#include "../../src/util.h"
+#include "../../src/loader/shaders.h"
+#include "../../src/graphics/texturing.h"
+namespace pipelines { namespace cull_instances {
+struct ComputeShader {
+    string key = "shaders/cull_instances.comp";
+    string getKey() const;
+    shared_ptr<Shader> build(OpenGLContext& context);
+};
+class Shaders {
+    ShaderCache& cache;
+public:
+    Shaders(ShaderCache& cache);
+    Shaders(ShaderCache* cache);
+    ShaderStages getStages() const;
+};
+struct alignas(16) CullingBlock {
+    alignas(16) glm::vec4 frustumPlanes[6];
+    alignas(16) glm::vec4 boundsCenter;
+    alignas(16) glm::vec4 boundsExtent;
+    uint32_t numInstances;
+};
+struct alignas(16) Instance {
+    glsl::mat4 modelMatrix;
+};
+struct alignas(16) AffineInstance {
+    alignas(16) glm::vec4 row0;
+    alignas(16) glm::vec4 row1;
+    alignas(16) glm::vec4 row2;
+};
+struct DrawCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int baseVertex;
+    uint32_t baseInstance;
+};
+const uint32_t LOCAL_SIZE_X = 64;
+const uint32_t LOCAL_SIZE_Y = 1;
+const uint32_t LOCAL_SIZE_Z = 1;
+struct ResourceBindingPipelineState;
+struct ResourceBindingCreateInfo;
+struct ResourceBindings {
+    const BufferView<CullingBlock> cullingBlock;
+    const BufferSlice<Instance> allInstances;
+    const BufferSlice<AffineInstance> visibleInstances;
+    const BufferSlice<DrawCommand> drawCommands;
+    using CreateInfo = ResourceBindingCreateInfo;
+    using PipelineState = ResourceBindingPipelineState;
+};
+struct ResourceBindingPipelineState {
+    void bindAll(const ResourceBindings& bindings, OpenGLContext& context);
+};
+struct ResourceBindingCreateInfo {
+    ResourceBindingPipelineState init();
+};
+using Pipeline = ComputePipeline<ResourceBindings>;
+using Create = ComputePipelineCreateInfo<ResourceBindings, Shaders>;
+using DispatchCmd = DispatchCommand<ResourceBindings>;
+}}
\ No newline at end of file
@@ -56,12 +56,15 @@ ShaderStages Shaders::getStages() const {
 void VertexBindingPipelineState::bindAll(const VertexBindings& bindings, BoundVertexArrayGuard& guard, OpenGLContext& context) {
     guard.bindVertexBuffer(0, bindings.perVertex.buffer, bindings.perVertex.byteOffset, sizeof(VertexInput));
 }
-VertexBindingPipelineState VertexBindingCreateInfo::init(VertexArray& array, OpenGLContext& context) {
-    context.withBoundVertexArray(array, [](auto guard) {
-        guard.enableAttribute(0);
-        guard.setAttributeFormat(0, DataFormat::R32G32B32_SFLOAT, offsetof(VertexInput, position));
-        guard.setAttributeBinding(0, 0);
-    });
+VertexLayout VertexBindingCreateInfo::getLayout() const {
+    return VertexLayout {
+        .attributes = {
+            { .location = 0, .binding = 0, .format = DataFormat::R32G32B32_SFLOAT, .offset = offsetof(VertexInput, position) },
+        },
+        .instancedBindings = {}
+    };
+}
+VertexBindingPipelineState VertexBindingCreateInfo::init() {
     return VertexBindingPipelineState {};
 }
 void ResourceBindingPipelineState::bindAll(const ResourceBindings& bindings, OpenGLContext& context) {
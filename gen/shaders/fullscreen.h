@@ -9,12 +9,12 @@
 #include "../../src/graphics/texturing.h"
 namespace pipelines { namespace fullscreen {
 struct VertexShader {
-    string key = "/home/chris/code/game_engine/res/shaders/fullscreen.vert";
+    string key = "shaders/fullscreen.vert";
     string getKey() const;
     shared_ptr<Shader> build(OpenGLContext& context);
 };
 struct FragmentShader {
-    string key = "/home/chris/code/game_engine/res/shaders/fullscreen.frag";
+    string key = "shaders/fullscreen.frag";
     string getKey() const;
     shared_ptr<Shader> build(OpenGLContext& context);
 };
@@ -39,7 +39,8 @@ struct VertexBindingPipelineState {
     void bindAll(const VertexBindings& bindings, BoundVertexArrayGuard& guard, OpenGLContext& context);
 };
 struct VertexBindingCreateInfo {
-    VertexBindingPipelineState init(VertexArray& array, OpenGLContext& context);
+    VertexLayout getLayout() const;
+    VertexBindingPipelineState init();
 };
 struct ResourceBindingPipelineState;
 struct ResourceBindingCreateInfo;
@@ -4,6 +4,18 @@ namespace pipelines { namespace lighting_test {
 const char* VERTEX_SHADER = R""(
 #version 420
 #extension GL_ARB_shading_language_include : enable
+mat3 affineNormalMatrix(mat3x4 rows) {
+    mat3 m = mat3(transpose(rows));
+    mat3 cofactors = mat3(cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1]));
+    return cofactors / dot(m[0], cofactors[0]);
+}
+vec3 octahedralDecode(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if(v.z < 0.0) {
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(v);
+}
 
 #line 1 "/home/chris/code/game_engine/res/shaders/lighting/light.glsl"
 struct Light {
@@ -23,22 +35,25 @@ layout(location = 0)in vec3 vertexPosition;
 
 
     layout(location = 1)in vec2 vertexTexCoord;
-    layout(location = 2)in vec3 vertexNormal;
+    layout(location = 2)in vec2 vertexNormalOctahedral;
+#define vertexNormal octahedralDecode(vertexNormalOctahedral)
     out vec2 textureCoordinate;
 
 
 
 
 
-    layout(location = 3)in vec3 vertexTangent;
+    layout(location = 3)in vec2 vertexTangentOctahedral;
+#define vertexTangent octahedralDecode(vertexTangentOctahedral)
     out mat3 tbnMatrix;
 
 
 
 
 
-layout(location = 5)in mat4 modelMatrix;
-layout(location = 9)in mat3 normalMatrix;
+layout(location = 5)in mat3x4 modelMatrixAffine;
+#define modelMatrix mat4(transpose(modelMatrixAffine))
+#define normalMatrix affineNormalMatrix(modelMatrixAffine)
 
 
 out vec3 eyeSpacePosition;
@@ -361,7 +376,10 @@ void main(){
 
 
 
-        vec3 surfaceNormal = normalize(tbnMatrix *(255.0 / 128.0 * texture(normalMap, surfaceTextureCoordinate). xyz - 1));
+
+        vec2 tangentNormalXY = 255.0 / 128.0 * texture(normalMap, surfaceTextureCoordinate). xy - 1;
+        vec3 tangentNormal = vec3(tangentNormalXY, sqrt(max(0.0, 1.0 - dot(tangentNormalXY, tangentNormalXY))));
+        vec3 surfaceNormal = normalize(tbnMatrix * tangentNormal);
 
 
 
@@ -409,43 +427,21 @@ void VertexBindingPipelineState::bindAll(const VertexBindings& bindings, BoundVe
     guard.bindVertexBuffer(0, bindings.perVertex.buffer, bindings.perVertex.byteOffset, sizeof(VertexInput));
     guard.bindVertexBuffer(1, bindings.perInstance.buffer, bindings.perInstance.byteOffset, sizeof(InstanceInput));
 }
-VertexBindingPipelineState VertexBindingCreateInfo::init(VertexArray& array, OpenGLContext& context) {
-    context.withBoundVertexArray(array, [](auto guard) {
-        guard.enableAttribute(1);
-        guard.enableAttribute(0);
-        guard.enableAttribute(2);
-        guard.enableAttribute(3);
-        guard.enableAttribute(5);
-        guard.enableAttribute(6);
-        guard.enableAttribute(7);
-        guard.enableAttribute(8);
-        guard.enableAttribute(9);
-        guard.enableAttribute(10);
-        guard.enableAttribute(11);
-        guard.setAttributeFormat(1, DataFormat::R32G32_SFLOAT, offsetof(VertexInput, texCoord));
-        guard.setAttributeFormat(0, DataFormat::R32G32B32_SFLOAT, offsetof(VertexInput, position));
-        guard.setAttributeFormat(2, DataFormat::R32G32B32_SFLOAT, offsetof(VertexInput, normal));
-        guard.setAttributeFormat(3, DataFormat::R32G32B32_SFLOAT, offsetof(VertexInput, tangent));
-        guard.setAttributeFormat(5, DataFormat::R32G32B32A32_SFLOAT, offsetof(InstanceInput, modelMatrix.column0));
-        guard.setAttributeFormat(6, DataFormat::R32G32B32A32_SFLOAT, offsetof(InstanceInput, modelMatrix.column1));
-        guard.setAttributeFormat(7, DataFormat::R32G32B32A32_SFLOAT, offsetof(InstanceInput, modelMatrix.column2));
-        guard.setAttributeFormat(8, DataFormat::R32G32B32A32_SFLOAT, offsetof(InstanceInput, modelMatrix.column3));
-        guard.setAttributeFormat(9, DataFormat::R32G32B32_SFLOAT, offsetof(InstanceInput, normalMatrix.column0));
-        guard.setAttributeFormat(10, DataFormat::R32G32B32_SFLOAT, offsetof(InstanceInput, normalMatrix.column1));
-        guard.setAttributeFormat(11, DataFormat::R32G32B32_SFLOAT, offsetof(InstanceInput, normalMatrix.column2));
-        guard.setAttributeBinding(1, 0);
-        guard.setAttributeBinding(0, 0);
-        guard.setAttributeBinding(2, 0);
-        guard.setAttributeBinding(3, 0);
-        guard.setAttributeBinding(5, 1);
-        guard.setAttributeBinding(6, 1);
-        guard.setAttributeBinding(7, 1);
-        guard.setAttributeBinding(8, 1);
-        guard.setAttributeBinding(9, 1);
-        guard.setAttributeBinding(10, 1);
-        guard.setAttributeBinding(11, 1);
-        guard.setBindingDivisor(1, 1);
-    });
+VertexLayout VertexBindingCreateInfo::getLayout() const {
+    return VertexLayout {
+        .attributes = {
+            { .location = 0, .binding = 0, .format = DataFormat::R16G16B16A16_SFLOAT, .offset = offsetof(VertexInput, position) },
+            { .location = 1, .binding = 0, .format = DataFormat::R16G16_SFLOAT, .offset = offsetof(VertexInput, texCoord) },
+            { .location = 2, .binding = 0, .format = DataFormat::R16G16_SNORM, .offset = offsetof(VertexInput, normal) },
+            { .location = 3, .binding = 0, .format = DataFormat::R16G16_SNORM, .offset = offsetof(VertexInput, tangent) },
+            { .location = 5, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.row0) },
+            { .location = 6, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.row1) },
+            { .location = 7, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.row2) },
+        },
+        .instancedBindings = { 1 }
+    };
+}
+VertexBindingPipelineState VertexBindingCreateInfo::init() {
     return VertexBindingPipelineState {};
 }
 void ResourceBindingPipelineState::bindAll(const ResourceBindings& bindings, OpenGLContext& context) {
@@ -9,12 +9,12 @@
 #include "../../src/graphics/texturing.h"
 namespace pipelines { namespace lighting_test {
 struct VertexShader {
-    string key = "/home/chris/code/game_engine/res/shaders/lighting/all.vert";
+    string key = "shaders/lighting/all.vert#lighting_test";
     string getKey() const;
     shared_ptr<Shader> build(OpenGLContext& context);
 };
 struct FragmentShader {
-    string key = "/home/chris/code/game_engine/res/shaders/lighting/all.frag";
+    string key = "shaders/lighting/all.frag#lighting_test";
     string getKey() const;
     shared_ptr<Shader> build(OpenGLContext& context);
 };
@@ -48,14 +48,13 @@ struct alignas(16) LightingBlock {
     Light allLights[1];
 };
 struct VertexInput {
-    glm::vec2 texCoord;
-    glm::vec3 position;
-    glm::vec3 normal;
-    glm::vec3 tangent;
+    glsl::half2 texCoord;
+    glsl::half4 position;
+    glsl::octahedral normal;
+    glsl::octahedral tangent;
 };
 struct InstanceInput {
-    glsl::mat4 modelMatrix;
-    glsl::mat3 normalMatrix;
+    glsl::affine modelMatrix;
 };
 struct VertexBindingPipelineState;
 struct VertexBindingCreateInfo;
@@ -69,7 +68,8 @@ struct VertexBindingPipelineState {
     void bindAll(const VertexBindings& bindings, BoundVertexArrayGuard& guard, OpenGLContext& context);
 };
 struct VertexBindingCreateInfo {
-    VertexBindingPipelineState init(VertexArray& array, OpenGLContext& context);
+    VertexLayout getLayout() const;
+    VertexBindingPipelineState init();
 };
 struct ResourceBindingPipelineState;
 struct ResourceBindingCreateInfo;
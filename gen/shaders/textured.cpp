@@ -65,31 +65,21 @@ void VertexBindingPipelineState::bindAll(const VertexBindings& bindings, BoundVe
     guard.bindVertexBuffer(0, bindings.perVertex.buffer, bindings.perVertex.byteOffset, sizeof(VertexInput));
     guard.bindVertexBuffer(1, bindings.perInstance.buffer, bindings.perInstance.byteOffset, sizeof(InstanceInput));
 }
-VertexBindingPipelineState VertexBindingCreateInfo::init(VertexArray& array, OpenGLContext& context) {
-    context.withBoundVertexArray(array, [](auto guard) {
-        guard.enableAttribute(0);
-        guard.enableAttribute(2);
-        guard.enableAttribute(1);
-        guard.enableAttribute(3);
-        guard.enableAttribute(4);
-        guard.enableAttribute(5);
-        guard.enableAttribute(6);
-        guard.setAttributeFormat(0, DataFormat::R32G32B32_SFLOAT, offsetof(VertexInput, position));
-        guard.setAttributeFormat(2, DataFormat::R32G32_SFLOAT, offsetof(VertexInput, texCoord));
-        guard.setAttributeFormat(1, DataFormat::R32G32B32_SFLOAT, offsetof(VertexInput, normal));
-        guard.setAttributeFormat(3, DataFormat::R32G32B32A32_SFLOAT, offsetof(InstanceInput, modelMatrix.column0));
-        guard.setAttributeFormat(4, DataFormat::R32G32B32A32_SFLOAT, offsetof(InstanceInput, modelMatrix.column1));
-        guard.setAttributeFormat(5, DataFormat::R32G32B32A32_SFLOAT, offsetof(InstanceInput, modelMatrix.column2));
-        guard.setAttributeFormat(6, DataFormat::R32G32B32A32_SFLOAT, offsetof(InstanceInput, modelMatrix.column3));
-        guard.setAttributeBinding(0, 0);
-        guard.setAttributeBinding(2, 0);
-        guard.setAttributeBinding(1, 0);
-        guard.setAttributeBinding(3, 1);
-        guard.setAttributeBinding(4, 1);
-        guard.setAttributeBinding(5, 1);
-        guard.setAttributeBinding(6, 1);
-        guard.setBindingDivisor(1, 1);
-    });
+VertexLayout VertexBindingCreateInfo::getLayout() const {
+    return VertexLayout {
+        .attributes = {
+            { .location = 0, .binding = 0, .format = DataFormat::R32G32B32_SFLOAT, .offset = offsetof(VertexInput, position) },
+            { .location = 1, .binding = 0, .format = DataFormat::R32G32B32_SFLOAT, .offset = offsetof(VertexInput, normal) },
+            { .location = 2, .binding = 0, .format = DataFormat::R32G32_SFLOAT, .offset = offsetof(VertexInput, texCoord) },
+            { .location = 3, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.column0) },
+            { .location = 4, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.column1) },
+            { .location = 5, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.column2) },
+            { .location = 6, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.column3) },
+        },
+        .instancedBindings = { 1 }
+    };
+}
+VertexBindingPipelineState VertexBindingCreateInfo::init() {
     return VertexBindingPipelineState {};
 }
 void ResourceBindingPipelineState::bindAll(const ResourceBindings& bindings, OpenGLContext& context) {
@@ -9,12 +9,12 @@
 #include "../../src/graphics/texturing.h"
 namespace pipelines { namespace textured {
 struct VertexShader {
-    string key = "/home/chris/code/game_engine/res/shaders/textured.vert";
+    string key = "shaders/textured.vert";
     string getKey() const;
     shared_ptr<Shader> build(OpenGLContext& context);
 };
 struct FragmentShader {
-    string key = "/home/chris/code/game_engine/res/shaders/textured.frag";
+    string key = "shaders/textured.frag";
     string getKey() const;
     shared_ptr<Shader> build(OpenGLContext& context);
 };
@@ -48,7 +48,8 @@ struct VertexBindingPipelineState {
     void bindAll(const VertexBindings& bindings, BoundVertexArrayGuard& guard, OpenGLContext& context);
 };
 struct VertexBindingCreateInfo {
-    VertexBindingPipelineState init(VertexArray& array, OpenGLContext& context);
+    VertexLayout getLayout() const;
+    VertexBindingPipelineState init();
 };
 struct ResourceBindingPipelineState;
 struct ResourceBindingCreateInfo;
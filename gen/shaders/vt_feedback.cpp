@@ -0,0 +1,123 @@
+#include "vt_feedback.h"
+#include <memory>
+namespace pipelines { namespace vt_feedback {
+const char* VERTEX_SHADER = R""(
+#version 420
+#extension GL_ARB_shading_language_include : enable
+
+layout(location = 0)in vec3 vertexPosition;
+layout(location = 1)in vec2 vertexTexCoord;
+layout(location = 2)in mat4 modelMatrix;
+
+layout(std140, binding = 0)uniform MatrixBlock {
+    mat4 viewProjectionMatrix;
+};
+
+out vec2 virtualCoordinate;
+
+void main(void){
+    gl_Position = viewProjectionMatrix * modelMatrix * vec4(vertexPosition, 1.0);
+    virtualCoordinate = vertexTexCoord;
+}
+)"";
+string VertexShader::getKey() const { return key; }
+shared_ptr<Shader> VertexShader::build(OpenGLContext& context) {
+    return make_shared<Shader>(std::move(context.buildShader(ShaderType::VERTEX, key, VERTEX_SHADER)));
+}
+const char* FRAGMENT_SHADER = R""(
+#version 420
+#extension GL_ARB_shading_language_include : enable
+
+in vec2 virtualCoordinate;
+layout(location = 0)out vec4 color;
+
+#line 1 "/home/chris/code/game_engine/res/shaders/virtualTexture.glsl"
+
+
+
+
+layout(std140, binding = 1)uniform VirtualTextureBlock {
+
+    float virtualPages;
+    float maxLevel;
+    float pageSize;
+
+    float physicalPages;
+
+    float borderFraction;
+
+    float feedbackBias;
+
+    float textureId;
+};
+
+
+
+
+
+
+float vtMipLevel(vec2 uv){
+    vec2 texels = uv * virtualPages * pageSize;
+    vec2 dx = dFdx(texels);
+    vec2 dy = dFdy(texels);
+    return 0.5 * log2(max(dot(dx, dx), dot(dy, dy)));
+}
+
+
+    vec4 vtFeedback(vec2 uv){
+        float level = clamp(floor(vtMipLevel(uv)+ feedbackBias), 0.0, maxLevel);
+        float pages = virtualPages / exp2(level);
+        vec2 page = clamp(floor(fract(uv)* pages), vec2(0.0), vec2(pages - 1.0));
+        return vec4(page, level, textureId)/ 255.0;
+    }
+
+#line 7 "source"
+
+void main(void){
+
+        color = vtFeedback(virtualCoordinate);
+
+
+
+}
+)"";
+string FragmentShader::getKey() const { return key; }
+shared_ptr<Shader> FragmentShader::build(OpenGLContext& context) {
+    return make_shared<Shader>(std::move(context.buildShader(ShaderType::FRAGMENT, key, FRAGMENT_SHADER)));
+}
+Shaders::Shaders(ShaderCache* cache) : cache(*cache) {}
+Shaders::Shaders(ShaderCache& cache) : cache(cache) {}
+ShaderStages Shaders::getStages() const {
+    return {
+    .vertex = cache.get(VertexShader {}),
+    .fragment = cache.get(FragmentShader {}),
+    };
+};
+void VertexBindingPipelineState::bindAll(const VertexBindings& bindings, BoundVertexArrayGuard& guard, OpenGLContext& context) {
+    guard.bindVertexBuffer(0, bindings.perVertex.buffer, bindings.perVertex.byteOffset, sizeof(VertexInput));
+    guard.bindVertexBuffer(1, bindings.perInstance.buffer, bindings.perInstance.byteOffset, sizeof(InstanceInput));
+}
+VertexLayout VertexBindingCreateInfo::getLayout() const {
+    return VertexLayout {
+        .attributes = {
+            { .location = 0, .binding = 0, .format = DataFormat::R32G32B32_SFLOAT, .offset = offsetof(VertexInput, position) },
+            { .location = 1, .binding = 0, .format = DataFormat::R32G32_SFLOAT, .offset = offsetof(VertexInput, texCoord) },
+            { .location = 2, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.column0) },
+            { .location = 3, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.column1) },
+            { .location = 4, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.column2) },
+            { .location = 5, .binding = 1, .format = DataFormat::R32G32B32A32_SFLOAT, .offset = offsetof(InstanceInput, modelMatrix.column3) },
+        },
+        .instancedBindings = { 1 }
+    };
+}
+VertexBindingPipelineState VertexBindingCreateInfo::init() {
+    return VertexBindingPipelineState {};
+}
+void ResourceBindingPipelineState::bindAll(const ResourceBindings& bindings, OpenGLContext& context) {
+    context.bindUniformBuffer(bindings.matrixBlock.buffer, 0, bindings.matrixBlock.byteOffset, sizeof(MatrixBlock));
+    context.bindUniformBuffer(bindings.virtualTextureBlock.buffer, 1, bindings.virtualTextureBlock.byteOffset, sizeof(VirtualTextureBlock));
+}
+ResourceBindingPipelineState ResourceBindingCreateInfo::init() {
+    return ResourceBindingPipelineState {};
+}
+}}
\ No newline at end of file
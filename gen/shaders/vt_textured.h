@@ -0,0 +1,81 @@
+#pragma once
+// autogenerated from GLSL, do not edit
+#include <glm/glm.hpp>
+#include "../../src/graphics/OpenGLContext.h"
+#include "../../src/graphics/commands.h"
+#include "../../src/graphics/Shader.h"
+#include "../../src/util.h"
+#include "../../src/loader/shaders.h"
+#include "../../src/graphics/texturing.h"
+namespace pipelines { namespace vt_textured {
+struct VertexShader {
+    string key = "shaders/virtual_texture.vert";
+    string getKey() const;
+    shared_ptr<Shader> build(OpenGLContext& context);
+};
+struct FragmentShader {
+    string key = "shaders/virtual_texture.frag";
+    string getKey() const;
+    shared_ptr<Shader> build(OpenGLContext& context);
+};
+class Shaders {
+    ShaderCache& cache;
+public:
+    Shaders(ShaderCache& cache);
+    Shaders(ShaderCache* cache);
+    ShaderStages getStages() const;
+};
+struct alignas(16) MatrixBlock {
+    glsl::mat4 viewProjectionMatrix;
+};
+struct alignas(16) VirtualTextureBlock {
+    float virtualPages;
+    float maxLevel;
+    float pageSize;
+    float physicalPages;
+    float borderFraction;
+    float feedbackBias;
+    float textureId;
+};
+struct VertexInput {
+    glm::vec3 position;
+    glm::vec2 texCoord;
+};
+struct InstanceInput {
+    glsl::mat4 modelMatrix;
+};
+struct VertexBindingPipelineState;
+struct VertexBindingCreateInfo;
+struct VertexBindings {
+    const VertexBufferBinding<VertexInput> perVertex;
+    const VertexBufferBinding<InstanceInput> perInstance;
+    using CreateInfo = VertexBindingCreateInfo;
+    using PipelineState = VertexBindingPipelineState;
+};
+struct VertexBindingPipelineState {
+    void bindAll(const VertexBindings& bindings, BoundVertexArrayGuard& guard, OpenGLContext& context);
+};
+struct VertexBindingCreateInfo {
+    VertexLayout getLayout() const;
+    VertexBindingPipelineState init();
+};
+struct ResourceBindingPipelineState;
+struct ResourceBindingCreateInfo;
+struct ResourceBindings {
+    const BufferView<MatrixBlock> matrixBlock;
+    const BufferView<VirtualTextureBlock> virtualTextureBlock;
+    const TextureBinding<Texture2d> pageTable;
+    const TextureBinding<Texture2d> physicalCache;
+    using CreateInfo = ResourceBindingCreateInfo;
+    using PipelineState = ResourceBindingPipelineState;
+};
+struct ResourceBindingPipelineState {
+    void bindAll(const ResourceBindings& bindings, OpenGLContext& context);
+};
+struct ResourceBindingCreateInfo {
+    ResourceBindingPipelineState init();
+};
+using Pipeline = GraphicsPipeline<VertexBindings, ResourceBindings>;
+using Create = GraphicsPipelineCreateInfo<VertexBindings, ResourceBindings, Shaders>;
+using DrawCmd = DrawCommand<VertexBindings, ResourceBindings>;
+}}
\ No newline at end of file
@@ -87,7 +87,10 @@ void main() {
     #endif
 
     #if USE_NORMAL_MAP
-        vec3 surfaceNormal = normalize(tbnMatrix * (255.0/128.0 * texture(normalMap, surfaceTextureCoordinate).xyz - 1));
+        // normal maps only store X and Y (RG8 or BC5), Z is always positive in tangent space
+        vec2 tangentNormalXY = 255.0/128.0 * texture(normalMap, surfaceTextureCoordinate).xy - 1;
+        vec3 tangentNormal = vec3(tangentNormalXY, sqrt(max(0.0, 1.0 - dot(tangentNormalXY, tangentNormalXY))));
+        vec3 surfaceNormal = normalize(tbnMatrix * tangentNormal);
     #else
         vec3 surfaceNormal = normalize(fragNormalMatrix * passNormal);
     #endif
@@ -0,0 +1,53 @@
+// the virtual texture is split into square pages, only the ones which are on screen live in `physicalCache`.
+// `pageTable` has a texel per page (and a mip level per virtual mip level), pointing to where the page,
+// or the closest coarser page which is resident, is in the cache. see `src/loader/virtual_texture.h`
+
+layout(std140, binding = 1) uniform VirtualTextureBlock {
+    // along each side at level 0, a power of two
+    float virtualPages;
+    float maxLevel;
+    float pageSize;
+    // along each side of the cache
+    float physicalPages;
+    // how much of each page in the cache is border, so bilinear filtering never reads the neighbouring page
+    float borderFraction;
+    // the feedback pass renders at a lower resolution, so it asks for finer levels to make up for it
+    float feedbackBias;
+    // written to the feedback buffer, so requests can be told apart when several virtual textures are on screen
+    float textureId;
+};
+
+#if !FEEDBACK
+    layout(binding = 0) uniform sampler2D pageTable;
+    layout(binding = 1) uniform sampler2D physicalCache;
+#endif
+
+float vtMipLevel(vec2 uv) {
+    vec2 texels = uv * virtualPages * pageSize;
+    vec2 dx = dFdx(texels);
+    vec2 dy = dFdy(texels);
+    return 0.5 * log2(max(dot(dx, dx), dot(dy, dy)));
+}
+
+#if FEEDBACK
+    // x, y and level of the page which is needed, divided by 255 for an RGBA8 target
+    vec4 vtFeedback(vec2 uv) {
+        float level = clamp(floor(vtMipLevel(uv) + feedbackBias), 0.0, maxLevel);
+        float pages = virtualPages / exp2(level);
+        vec2 page = clamp(floor(fract(uv) * pages), vec2(0.0), vec2(pages - 1.0));
+        return vec4(page, level, textureId) / 255.0;
+    }
+#else
+    vec4 vtSample(vec2 uv) {
+        float level = clamp(floor(vtMipLevel(uv)), 0.0, maxLevel);
+        float pages = virtualPages / exp2(level);
+        vec2 wrapped = fract(uv);
+        ivec2 page = ivec2(clamp(floor(wrapped * pages), vec2(0.0), vec2(pages - 1.0)));
+
+        // x, y of the page in the cache and the level it actually comes from
+        vec3 entry = round(texelFetch(pageTable, page, int(level)).xyz * 255.0);
+        vec2 withinPage = fract(wrapped * virtualPages / exp2(entry.z));
+        vec2 cacheUv = (entry.xy + borderFraction + withinPage * (1.0 - 2.0 * borderFraction)) / physicalPages;
+        return textureLod(physicalCache, cacheUv, 0.0);
+    }
+#endif
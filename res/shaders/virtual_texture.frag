@@ -0,0 +1,14 @@
+#version 420
+
+in vec2 virtualCoordinate;
+layout(location = 0) out vec4 color;
+
+#include "virtualTexture.glsl"
+
+void main(void) {
+    #if FEEDBACK
+        color = vtFeedback(virtualCoordinate);
+    #else
+        color = vec4(vtSample(virtualCoordinate).rgb, 1.0);
+    #endif
+}
@@ -0,0 +1,16 @@
+#version 420
+
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec2 vertexTexCoord;
+layout(location = 2) in mat4 modelMatrix;
+
+layout(std140, binding = 0) uniform MatrixBlock {
+    mat4 viewProjectionMatrix;
+};
+
+out vec2 virtualCoordinate;
+
+void main(void) {
+    gl_Position = viewProjectionMatrix * modelMatrix * vec4(vertexPosition, 1.0);
+    virtualCoordinate = vertexTexCoord;
+}
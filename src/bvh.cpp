@@ -0,0 +1,243 @@
+#include "bvh.h"
+
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+// where the ray enters the box, if it does within [0, maxDistance]
+static optional<float> intersectRay(const BoundingBox& box, glm::vec3 origin, glm::vec3 inverseDirection, float maxDistance) {
+    // slab test. an axis the ray runs parallel to is checked separately: an origin lying on one of that axis'
+    // planes would make the distance to it 0 * infinity = NaN
+    float enter = 0.0f;
+    float exit = maxDistance;
+    for(int axis = 0; axis < 3; axis++) {
+        if(isinf(inverseDirection[axis])) {
+            if(origin[axis] < box.min[axis] || origin[axis] > box.max[axis]) {
+                return nullopt;
+            }
+            continue;
+        }
+        float t0 = (box.min[axis] - origin[axis]) * inverseDirection[axis];
+        float t1 = (box.max[axis] - origin[axis]) * inverseDirection[axis];
+        enter = max(enter, min(t0, t1));
+        exit = min(exit, max(t0, t1));
+    }
+    if(enter > exit) {
+        return nullopt;
+    }
+    return enter;
+}
+
+void Bvh::build(span<const BoundingBox> bounds) {
+    itemBounds.assign(bounds.begin(), bounds.end());
+    itemOrder.resize(bounds.size());
+    iota(itemOrder.begin(), itemOrder.end(), 0);
+    itemLeaves.assign(bounds.size(), BVH_NO_NODE);
+    nodes.clear();
+    // a binary tree with at least one item per leaf has fewer than twice as many nodes as items
+    nodes.reserve(max<size_t>(1, 2 * bounds.size()));
+    if(bounds.empty()) {
+        nodeDirty.clear();
+        return;
+    }
+
+    vector<glm::vec3> centroids;
+    centroids.reserve(bounds.size());
+    for(auto& box : bounds) {
+        centroids.push_back(box.getCenter());
+    }
+
+    nodes.push_back(BvhNode { .first = 0, .itemCount = static_cast<uint32_t>(bounds.size()), .parent = BVH_NO_NODE });
+    subdivide(0, 0, centroids);
+    nodeDirty.assign(nodes.size(), false);
+}
+
+void Bvh::subdivide(uint32_t nodeIndex, size_t depth, const vector<glm::vec3>& centroids) {
+    uint32_t first = nodes[nodeIndex].first;
+    uint32_t count = nodes[nodeIndex].itemCount;
+    BoundingBox bounds;
+    BoundingBox centroidBounds;
+    for(uint32_t i = first; i < first + count; i++) {
+        bounds.extend(itemBounds[itemOrder[i]]);
+        centroidBounds.extend(centroids[itemOrder[i]]);
+    }
+    nodes[nodeIndex].bounds = bounds;
+
+    auto makeLeaf = [&]() {
+        for(uint32_t i = first; i < first + count; i++) {
+            itemLeaves[itemOrder[i]] = nodeIndex;
+        }
+    };
+    if(count <= BVH_MIN_LEAF_ITEMS) {
+        makeLeaf();
+        return;
+    }
+
+    // bins along the axis where the centroids are spread out the most
+    glm::vec3 spread = centroidBounds.max - centroidBounds.min;
+    int axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+    uint32_t splitIndex = first + count / 2;
+    bool splitAtMedian = true;
+    if(spread[axis] <= 0.0f) {
+        // every centroid is in the same place, any split is as good as another
+        if(count <= BVH_MAX_LEAF_ITEMS) {
+            makeLeaf();
+            return;
+        }
+    } else if(depth < BVH_SAH_MAX_DEPTH) {
+        struct Bin {
+            BoundingBox bounds;
+            uint32_t count = 0;
+        };
+        Bin bins[BVH_BINS];
+        float binScale = BVH_BINS / spread[axis];
+        auto binOf = [&](uint32_t item) {
+            return min<size_t>(BVH_BINS - 1, size_t((centroids[item][axis] - centroidBounds.min[axis]) * binScale));
+        };
+        for(uint32_t i = first; i < first + count; i++) {
+            Bin& bin = bins[binOf(itemOrder[i])];
+            bin.bounds.extend(itemBounds[itemOrder[i]]);
+            bin.count++;
+        }
+
+        // sweep from the right to find the cost of everything right of each plane, then from the left
+        float rightCost[BVH_BINS];
+        BoundingBox right;
+        uint32_t rightCount = 0;
+        for(size_t i = BVH_BINS - 1; i > 0; i--) {
+            right.extend(bins[i].bounds);
+            rightCount += bins[i].count;
+            rightCost[i] = rightCount * right.getSurfaceArea();
+        }
+        BoundingBox left;
+        uint32_t leftCount = 0;
+        float bestCost = numeric_limits<float>::max();
+        size_t bestPlane = 0;
+        for(size_t i = 1; i < BVH_BINS; i++) {
+            left.extend(bins[i - 1].bounds);
+            leftCount += bins[i - 1].count;
+            float cost = leftCount * left.getSurfaceArea() + rightCost[i];
+            if(leftCount > 0 && leftCount < count && cost < bestCost) {
+                bestCost = cost;
+                bestPlane = i;
+            }
+        }
+
+        // the traversal cost of the split is left out, which slightly favours splitting
+        float leafCost = count * bounds.getSurfaceArea();
+        if(bestPlane == 0 || (bestCost >= leafCost && count <= BVH_MAX_LEAF_ITEMS)) {
+            if(count <= BVH_MAX_LEAF_ITEMS) {
+                makeLeaf();
+                return;
+            }
+        } else {
+            auto middle = partition(itemOrder.begin() + first, itemOrder.begin() + first + count, [&](uint32_t item) {
+                return binOf(item) < bestPlane;
+            });
+            splitIndex = middle - itemOrder.begin();
+            splitAtMedian = false;
+        }
+    }
+    if(splitAtMedian) {
+        nth_element(itemOrder.begin() + first, itemOrder.begin() + splitIndex, itemOrder.begin() + first + count,
+                [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+    }
+
+    // children always come after their parent, which `refit` relies on
+    uint32_t leftIndex = nodes.size();
+    nodes.push_back(BvhNode { .first = first, .itemCount = splitIndex - first, .parent = nodeIndex });
+    nodes.push_back(BvhNode { .first = splitIndex, .itemCount = first + count - splitIndex, .parent = nodeIndex });
+    nodes[nodeIndex].first = leftIndex;
+    nodes[nodeIndex].itemCount = 0;
+    subdivide(leftIndex, depth + 1, centroids);
+    subdivide(leftIndex + 1, depth + 1, centroids);
+}
+
+void Bvh::setBounds(uint32_t item, const BoundingBox &bounds) {
+    itemBounds[item] = bounds;
+    nodeDirty[itemLeaves[item]] = true;
+}
+
+const BoundingBox &Bvh::getBounds(uint32_t item) const {
+    return itemBounds[item];
+}
+
+void Bvh::updateBounds(uint32_t nodeIndex) {
+    BvhNode& node = nodes[nodeIndex];
+    BoundingBox bounds;
+    if(node.itemCount > 0) {
+        for(uint32_t i = node.first; i < node.first + node.itemCount; i++) {
+            bounds.extend(itemBounds[itemOrder[i]]);
+        }
+    } else {
+        bounds.extend(nodes[node.first].bounds);
+        bounds.extend(nodes[node.first + 1].bounds);
+    }
+    node.bounds = bounds;
+}
+
+void Bvh::refit() {
+    // backwards, so both children are done before their parent
+    for(size_t i = nodes.size(); i-- > 0;) {
+        if(!nodeDirty[i]) {
+            continue;
+        }
+        nodeDirty[i] = false;
+        updateBounds(i);
+        if(nodes[i].parent != BVH_NO_NODE) {
+            nodeDirty[nodes[i].parent] = true;
+        }
+    }
+}
+
+optional<RayHit> Bvh::raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const {
+    if(nodes.empty()) {
+        return nullopt;
+    }
+    glm::vec3 inverseDirection = 1.0f / direction;
+    optional<RayHit> closest;
+
+    uint32_t stack[BVH_MAX_DEPTH];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while(stackSize > 0) {
+        const BvhNode& node = nodes[stack[--stackSize]];
+        float limit = closest ? closest->distance : maxDistance;
+        if(!intersectRay(node.bounds, origin, inverseDirection, limit)) {
+            continue;
+        }
+        if(node.itemCount > 0) {
+            for(uint32_t i = node.first; i < node.first + node.itemCount; i++) {
+                uint32_t item = itemOrder[i];
+                optional<float> distance = intersectRay(itemBounds[item], origin, inverseDirection, closest ? closest->distance : maxDistance);
+                if(distance && (!closest || *distance < closest->distance)) {
+                    closest = RayHit { .item = item, .distance = *distance };
+                }
+            }
+            continue;
+        }
+
+        // the nearer child is popped first, so hits in it can prune the other one
+        optional<float> leftDistance = intersectRay(nodes[node.first].bounds, origin, inverseDirection, limit);
+        optional<float> rightDistance = intersectRay(nodes[node.first + 1].bounds, origin, inverseDirection, limit);
+        bool leftFirst = leftDistance && (!rightDistance || *leftDistance <= *rightDistance);
+        if(leftFirst) {
+            if(rightDistance) {
+                stack[stackSize++] = node.first + 1;
+            }
+            stack[stackSize++] = node.first;
+        } else {
+            if(leftDistance) {
+                stack[stackSize++] = node.first;
+            }
+            if(rightDistance) {
+                stack[stackSize++] = node.first + 1;
+            }
+        }
+    }
+    return closest;
+}
+
+size_t Bvh::getNumItems() const {
+    return itemBounds.size();
+}
@@ -0,0 +1,142 @@
+#ifndef GAME_ENGINE_BVH_H
+#define GAME_ENGINE_BVH_H
+
+#include <span>
+#include <vector>
+#include <limits>
+#include <optional>
+#include <glm/glm.hpp>
+#include "culling.h"
+
+using namespace std;
+
+// candidate split planes per axis when building
+const size_t BVH_BINS = 12;
+// nodes with at most this many items are never split
+const uint32_t BVH_MIN_LEAF_ITEMS = 2;
+// nodes with more than this many items are split even when the heuristic says it isn't worth it
+const uint32_t BVH_MAX_LEAF_ITEMS = 8;
+const uint32_t BVH_NO_NODE = numeric_limits<uint32_t>::max();
+// below this depth nodes are split at the median instead, which keeps the whole tree within `BVH_MAX_DEPTH`
+// however badly the heuristic splits
+const size_t BVH_SAH_MAX_DEPTH = 32;
+// enough for 32-bit item counts, also bounds the traversal stacks
+const size_t BVH_MAX_DEPTH = 64;
+
+struct BvhNode {
+    BoundingBox bounds;
+    // leaves: the first of `itemCount` entries in `itemOrder`. inner nodes: the left child, the right one follows it
+    uint32_t first;
+    uint32_t itemCount;
+    uint32_t parent;
+};
+
+struct RayHit {
+    uint32_t item;
+    float distance;
+};
+
+// bounding volume hierarchy over the world space bounds of many items, e.g. every renderable instance.
+// items are referred to by the index they were built with. built top down with binned SAH (the surface
+// area heuristic), then kept up to date by `refit` as items move, which only touches the paths from
+// moved items to the root. refitting never changes the structure, so after lots of movement the tree
+// gets looser and should be rebuilt.
+class Bvh {
+    vector<BvhNode> nodes;
+    vector<BoundingBox> itemBounds;
+    vector<uint32_t> itemOrder;
+    vector<uint32_t> itemLeaves;
+    vector<bool> nodeDirty;
+
+    void subdivide(uint32_t nodeIndex, size_t depth, const vector<glm::vec3>& centroids);
+    void updateBounds(uint32_t nodeIndex);
+
+    // calls `callback` for every item below `nodeIndex`, without any more tests
+    template<typename F>
+    void forEachItem(uint32_t nodeIndex, F& callback) const {
+        uint32_t stack[BVH_MAX_DEPTH];
+        size_t stackSize = 0;
+        stack[stackSize++] = nodeIndex;
+        while(stackSize > 0) {
+            const BvhNode& node = nodes[stack[--stackSize]];
+            if(node.itemCount > 0) {
+                for(uint32_t i = node.first; i < node.first + node.itemCount; i++) {
+                    callback(itemOrder[i]);
+                }
+            } else {
+                stack[stackSize++] = node.first;
+                stack[stackSize++] = node.first + 1;
+            }
+        }
+    }
+
+    // visits every node for which `classify` isn't OUTSIDE, and skips the tests below nodes which are INSIDE.
+    // items of intersecting leaves are tested one by one
+    template<typename C, typename F>
+    void query(C classify, F& callback) const {
+        if(nodes.empty()) {
+            return;
+        }
+        uint32_t stack[BVH_MAX_DEPTH];
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while(stackSize > 0) {
+            uint32_t nodeIndex = stack[--stackSize];
+            const BvhNode& node = nodes[nodeIndex];
+            Containment containment = classify(node.bounds);
+            if(containment == Containment::OUTSIDE) {
+                continue;
+            }
+            if(containment == Containment::INSIDE) {
+                forEachItem(nodeIndex, callback);
+            } else if(node.itemCount > 0) {
+                for(uint32_t i = node.first; i < node.first + node.itemCount; i++) {
+                    if(classify(itemBounds[itemOrder[i]]) != Containment::OUTSIDE) {
+                        callback(itemOrder[i]);
+                    }
+                }
+            } else {
+                stack[stackSize++] = node.first;
+                stack[stackSize++] = node.first + 1;
+            }
+        }
+    }
+
+public:
+    // replaces the whole tree, item `i` has bounds `bounds[i]`
+    void build(span<const BoundingBox> bounds);
+
+    // the tree is only updated by the next `refit`
+    void setBounds(uint32_t item, const BoundingBox& bounds);
+    const BoundingBox& getBounds(uint32_t item) const;
+    // recomputes the bounds of every node above an item which was moved by `setBounds`
+    void refit();
+
+    // items whose bounds intersect `frustum`, e.g. the camera's for visibility, or a light's for its shadow casters
+    template<typename F>
+    void queryFrustum(const Frustum& frustum, F callback) const {
+        query([&](const BoundingBox& box) { return frustum.classify(box); }, callback);
+    }
+
+    // items whose bounds intersect `box`, e.g. everything in range of a point light
+    template<typename F>
+    void queryBox(const BoundingBox& box, F callback) const {
+        query([&](const BoundingBox& other) {
+            if(glm::any(glm::greaterThan(other.min, box.max)) || glm::any(glm::lessThan(other.max, box.min))) {
+                return Containment::OUTSIDE;
+            }
+            if(glm::all(glm::greaterThanEqual(other.min, box.min)) && glm::all(glm::lessThanEqual(other.max, box.max))) {
+                return Containment::INSIDE;
+            }
+            return Containment::INTERSECTING;
+        }, callback);
+    }
+
+    // the item whose bounds are hit first by the ray, within `maxDistance` (in multiples of `direction`).
+    // only tests the bounds, so callers wanting exact picks should test the hit item's triangles themselves
+    optional<RayHit> raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance = numeric_limits<float>::max()) const;
+
+    size_t getNumItems() const;
+};
+
+#endif //GAME_ENGINE_BVH_H
@@ -1,6 +1,7 @@
 #include <cassert>
 #include <fmt/format.h>
 #include <sstream>
+#include <algorithm>
 
 #define LOGURU_WITH_STREAMS 1
 #include <loguru/loguru.hpp>
@@ -10,6 +11,36 @@
 
 using namespace fmt::v6;
 
+// the base alignment of a std430 member, arrays are aligned like their elements
+static size_t get_std430_alignment(const glslang::TType* type) {
+    if(type->isStruct()) {
+        size_t alignment = 4;
+        for(auto& field : *type->getStruct()) {
+            alignment = max(alignment, get_std430_alignment(field.type));
+        }
+        return alignment;
+    } else if(type->isMatrix()) {
+        // stored as an array of column vectors
+        return type->getMatrixRows() == 2 ? 8 : 16;
+    } else if(type->isVector()) {
+        return type->getVectorSize() == 2 ? 8 : 16;
+    }
+    return 4;
+}
+
+size_t get_struct_alignment(AlignmentRequirements alignment, const vector<Field>& fields) {
+    if(alignment == AlignmentRequirements::STD140) {
+        return 4 * sizeof(float);
+    } else if(alignment == AlignmentRequirements::STD430) {
+        size_t structAlignment = 4;
+        for(auto& field : fields) {
+            structAlignment = max(structAlignment, get_std430_alignment(field.originalType));
+        }
+        return structAlignment > 4 ? structAlignment : 0;
+    }
+    return 0;
+}
+
 Type get_type(const glslang::TType* type, AlignmentRequirements alignment, vector<string>& defs) {
     Type output {
         .base = "",
@@ -35,13 +66,17 @@ Type get_type(const glslang::TType* type, AlignmentRequirements alignment, vecto
             mappedFields.push_back(Field {
                 .name = string(fieldName),
                 .type = fieldType,
+                .originalType = field.type,
                 .location = nullopt
             });
         }
 
         stringstream out;
         emit_struct(type->getTypeName().c_str(), alignment, mappedFields, [](auto o) {}, out);
-        defs.push_back(out.str());
+        // a struct can be shared by several blocks, but must only be defined once
+        if(find(defs.begin(), defs.end(), out.str()) == defs.end()) {
+            defs.push_back(out.str());
+        }
 
         output.base = type->getTypeName();
     } else if(type->isMatrix()) {
@@ -55,7 +90,7 @@ Type get_type(const glslang::TType* type, AlignmentRequirements alignment, vecto
         }
     } else if(type->isVector()) {
         if(type->getBasicString() == "float") {
-            if(alignment == AlignmentRequirements::STD140) {
+            if(alignment != AlignmentRequirements::C_DEFAULT) {
                 int alignment;
                 if(type->getVectorSize() == 3) {
                     alignment = 4 * sizeof(float);
@@ -69,6 +104,8 @@ Type get_type(const glslang::TType* type, AlignmentRequirements alignment, vecto
         } else {
             assert(false);
         }
+    } else if(type->getBasicType() == glslang::EbtUint) {
+        output.base = "uint32_t";
     } else {
         output.base = type->getBasicString();
     }
@@ -92,9 +129,121 @@ string get_data_format(const std::string_view& basicString, int vectorSize) {
     return "DataFormat::UNKNOWN";
 }
 
+optional<Quantization> parse_quantization(const std::string_view& name) {
+    if(name == "half") {
+        return Quantization::HALF;
+    } else if(name == "octahedral") {
+        return Quantization::OCTAHEDRAL;
+    } else if(name == "unorm8") {
+        return Quantization::UNORM8;
+    }
+    return nullopt;
+}
+
+optional<InstanceTransform> parse_instance_transform(const std::string_view& name) {
+    if(name == "full") {
+        return InstanceTransform::FULL;
+    } else if(name == "affine") {
+        return InstanceTransform::AFFINE;
+    } else if(name == "trs") {
+        return InstanceTransform::TRS;
+    }
+    return nullopt;
+}
+
+string get_quantized_data_format(Quantization quantization, int vectorSize) {
+    switch(quantization) {
+        case Quantization::HALF:
+            // vec3s are padded to 4 components to keep attributes 4-byte aligned
+            return vectorSize == 2 ? "DataFormat::R16G16_SFLOAT" : "DataFormat::R16G16B16A16_SFLOAT";
+        case Quantization::OCTAHEDRAL:
+            return "DataFormat::R16G16_SNORM";
+        case Quantization::UNORM8:
+            return "DataFormat::R8G8B8A8_UNORM";
+        default:
+            assert(false);
+            return "DataFormat::UNKNOWN";
+    }
+}
+
+bool Field::quantize(Quantization q) {
+    if(originalType->isMatrix() || !originalType->isVector() || originalType->getBasicString() != string("float")) {
+        LOG_S(ERROR) << "cannot quantize `" << name << "`, only float vectors can be quantized";
+        return false;
+    }
+
+    int vectorSize = originalType->getVectorSize();
+    switch(q) {
+        case Quantization::HALF:
+            type.base = vectorSize == 2 ? "glsl::half2" : "glsl::half4";
+            break;
+        case Quantization::OCTAHEDRAL:
+            if(vectorSize != 3) {
+                LOG_S(ERROR) << "octahedral quantization of `" << name << "` requires a vec3";
+                return false;
+            }
+            type.base = "glsl::octahedral";
+            break;
+        case Quantization::UNORM8:
+            if(vectorSize < 3) {
+                LOG_S(ERROR) << "unorm8 quantization of `" << name << "` requires a vec3 or vec4";
+                return false;
+            }
+            type.base = "glsl::unorm8x4";
+            break;
+        default:
+            break;
+    }
+    quantization = q;
+    return true;
+}
+
+bool Field::encodeTransform(InstanceTransform t) {
+    if(!originalType->isMatrix() || originalType->getMatrixCols() != 4 || originalType->getMatrixRows() != 4) {
+        LOG_S(ERROR) << "cannot encode `" << name << "` as a compact transform, it must be a mat4";
+        return false;
+    }
+
+    switch(t) {
+        case InstanceTransform::AFFINE:
+            type.base = "glsl::affine";
+            break;
+        case InstanceTransform::TRS:
+            type.base = "glsl::trs";
+            break;
+        default:
+            break;
+    }
+    transform = t;
+    return true;
+}
+
+// the vec4 members of a compact transform, in the order of the shader input's columns
+static vector<string> get_transform_members(InstanceTransform transform) {
+    switch(transform) {
+        case InstanceTransform::AFFINE:
+            return { "row0", "row1", "row2" };
+        case InstanceTransform::TRS:
+            return { "positionScale", "rotation" };
+        default:
+            assert(false);
+            return {};
+    }
+}
+
 void gather_attributes(const Field &field, const std::string_view& structName, int binding, vector<VertexAttribute>& attrs) {
     assert(!field.type.numElements.has_value());
-    if(field.originalType->isMatrix()) {
+    if(field.transform != InstanceTransform::FULL) {
+        vector<string> members = get_transform_members(field.transform);
+        for(size_t i = 0; i < members.size(); i++) {
+            attrs.push_back({
+                    .location = field.location.value() + static_cast<int>(i),
+                    .offsetExpr = format("offsetof({}, {}.{})", structName, field.name, members[i]),
+                    .dataFormat = "DataFormat::R32G32B32A32_SFLOAT",
+                    .binding = binding
+            });
+        }
+    } else if(field.originalType->isMatrix()) {
         for(int i = 0; i < field.originalType->getMatrixCols(); i++) {
             attrs.push_back({
                     .location = field.location.value() + i,
@@ -107,22 +256,27 @@ void gather_attributes(const Field &field, const std::string_view& structName, i
         attrs.push_back({
                  .location = field.location.value(),
                  .offsetExpr = format("offsetof({}, {})", structName, field.name),
-                 .dataFormat = get_data_format(field.originalType->getBasicString(), field.originalType->getVectorSize()),
+                 .dataFormat = field.quantization == Quantization::NONE
+                         ? get_data_format(field.originalType->getBasicString(), field.originalType->getVectorSize())
+                         : get_quantized_data_format(field.quantization, field.originalType->getVectorSize()),
                  .binding = binding
         });
     }
 }
 
-void write_attributes(const vector<VertexAttribute>& attributes, ostream &out) {
+void write_vertex_layout(vector<VertexAttribute> attributes, const vector<int>& instancedBindings, ostream &out) {
+    sort(attributes.begin(), attributes.end(), [](auto& a, auto& b) { return a.location < b.location; });
+    out << "        .attributes = {\n";
     for(auto& attribute : attributes) {
-        out << "        guard.enableAttribute(" <<  attribute.location << ");\n";
+        out << "            { .location = " << attribute.location << ", .binding = " << attribute.binding
+            << ", .format = " << attribute.dataFormat << ", .offset = " << attribute.offsetExpr << " },\n";
     }
-    for(auto& attribute : attributes) {
-        out << "        guard.setAttributeFormat(" << attribute.location << ", " << attribute.dataFormat << ", " << attribute.offsetExpr << ");\n";
-    }
-    for(auto& attribute : attributes) {
-        out << "        guard.setAttributeBinding(" << attribute.location << ", " << attribute.binding << ");\n";
+    out << "        },\n";
+    out << "        .instancedBindings = {";
+    for(size_t i = 0; i < instancedBindings.size(); i++) {
+        out << (i == 0 ? " " : ", ") << instancedBindings[i];
     }
+    out << (instancedBindings.empty() ? "}\n" : " }\n");
 }
 
 optional<Field> Field::create_from_sampler(const glslang::TObjectReflection& uniform) {
@@ -138,6 +292,9 @@ optional<Field> Field::create_from_sampler(const glslang::TObjectReflection& uni
         case GL_SAMPLER_2D:
             f.type = Type { .base = "const TextureBinding<Texture2d>", .numElements = nullopt };
             break;
+        case GL_SAMPLER_2D_ARRAY:
+            f.type = Type { .base = "const TextureBinding<Texture2dArray>", .numElements = nullopt };
+            break;
         case GL_SAMPLER_CUBE:
             f.type = Type { .base = "const TextureBinding<TextureCube>", .numElements = nullopt };
             break;
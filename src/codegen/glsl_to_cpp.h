@@ -10,6 +10,32 @@
 
 using namespace std;
 
+// a compact encoding for a vertex input, selected with `--quantize [name]=[quantization]`
+enum class Quantization {
+    NONE,
+    // 16-bit floats (vec2, vec3 or vec4)
+    HALF,
+    // unit vec3 encoded as two 16-bit snorms, decoded in the vertex shader
+    OCTAHEDRAL,
+    // vec3 or vec4 with components in [0, 1], e.g.: colors
+    UNORM8
+};
+
+optional<Quantization> parse_quantization(const std::string_view& name);
+
+// a compact encoding for the `modelMatrix` (and `normalMatrix`) instance inputs, selected with `--instance-transform`.
+// the vertex shader decodes it, so its body carries on using both matrices
+enum class InstanceTransform {
+    // mat4 and mat3, as declared: 112 bytes
+    FULL,
+    // the top three rows of the model matrix: 48 bytes. the normal matrix is rebuilt from its upper 3x3
+    AFFINE,
+    // position, uniform scale and rotation quaternion: 32 bytes
+    TRS
+};
+
+optional<InstanceTransform> parse_instance_transform(const std::string_view& name);
+
 struct Type {
     string base;
     optional<int> numElements;
@@ -20,6 +46,12 @@ struct Field {
     Type type;
     const glslang::TType* originalType;
     optional<int> location;
+    Quantization quantization = Quantization::NONE;
+    // only for the `modelMatrix` instance input
+    InstanceTransform transform = InstanceTransform::FULL;
+
+    bool quantize(Quantization q);
+    bool encodeTransform(InstanceTransform t);
 
     static optional<Field> create_from_pipe_input(const glslang::TObjectReflection& field, vector<string>& defs);
     static optional<Field> create_from_sampler(const glslang::TObjectReflection& uniform);
@@ -34,18 +66,25 @@ struct VertexAttribute {
 
 void gather_attributes(const Field &field, const std::string_view& structName, int binding, vector<VertexAttribute>& attrs);
 
-void write_attributes(const vector<VertexAttribute>& attributes, ostream& out);
+// writes the body of a `VertexLayout` initializer, the attributes are sorted by location so equal layouts compare equal
+void write_vertex_layout(vector<VertexAttribute> attributes, const vector<int>& instancedBindings, ostream& out);
 
 enum class AlignmentRequirements {
     C_DEFAULT,
-    STD140
+    STD140,
+    // shader storage blocks: like std140, except that structs and arrays aren't rounded up to 16 bytes
+    STD430
 };
 
+// the alignment a struct with these fields needs, or 0 if C's default is already right
+size_t get_struct_alignment(AlignmentRequirements alignment, const vector<Field>& fields);
+
 template<typename F>
 void emit_struct(const char* name, AlignmentRequirements alignment, vector<Field>& fields, F write_extra_defs, ostream& out) {
     out << "struct ";
-    if(alignment == AlignmentRequirements::STD140) {
-        out << "alignas(" << 4 * sizeof(float) << ") ";
+    size_t structAlignment = get_struct_alignment(alignment, fields);
+    if(structAlignment != 0) {
+        out << "alignas(" << structAlignment << ") ";
     }
     out << name << " {\n";
     for(auto& field : fields) {
@@ -8,9 +8,12 @@
 #include <variant>
 #include <bitset>
 #include <sstream>
+#include <iomanip>
 #include <ranges>
 #include <iostream>
 #include <bitset>
+#include <regex>
+#include <unordered_map>
 #include <fmt/format.h>
 
 #define LOGURU_WITH_STREAMS 1
@@ -69,6 +72,8 @@ struct Shader {
             return "VERTEX";
         } else if(shaderObject->getStage() == EShLangFragment) {
             return "FRAGMENT";
+        } else if(shaderObject->getStage() == EShLangCompute) {
+            return "COMPUTE";
         }
         return "UNKNOWN";
     }
@@ -118,10 +123,99 @@ ostream& operator<<(ostream& out, const Definition& def) {
 }
 
 const char *INCLUDE_EXTENSION = "#extension GL_GOOGLE_include_directive : enable\n";
+const char *SHADER_INCLUDE_EXTENSION = "#extension GL_ARB_shading_language_include : enable";
+
+const char *OCTAHEDRAL_DECODE = R"(
+vec3 octahedralDecode(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if(v.z < 0.0) {
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(v);
+})";
+
+const char *AFFINE_TRANSFORM_DECODE = R"(
+mat3 affineNormalMatrix(mat3x4 rows) {
+    mat3 m = mat3(transpose(rows));
+    mat3 cofactors = mat3(cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1]));
+    return cofactors / dot(m[0], cofactors[0]);
+})";
+
+const char *TRS_TRANSFORM_DECODE = R"(
+mat3 quaternionToMat3(vec4 q) {
+    vec3 q2 = q.xyz * 2.0;
+    vec3 qq = q.xyz * q2;
+    vec3 w = q.w * q2;
+    float xy = q.x * q2.y;
+    float xz = q.x * q2.z;
+    float yz = q.y * q2.z;
+    return mat3(1.0 - qq.y - qq.z, xy + w.z, xz - w.y,
+                xy - w.z, 1.0 - qq.x - qq.z, yz + w.x,
+                xz + w.y, yz - w.x, 1.0 - qq.x - qq.y);
+}
+mat4 trsModelMatrix(mat2x4 trs) {
+    mat3 m = quaternionToMat3(trs[1]) * trs[0].w;
+    return mat4(vec4(m[0], 0.0), vec4(m[1], 0.0), vec4(m[2], 0.0), vec4(trs[0].xyz, 1.0));
+}
+mat3 trsNormalMatrix(mat2x4 trs) {
+    return quaternionToMat3(trs[1]) / trs[0].w;
+})";
+
+string get_vertex_input_name(string name) {
+    name[0] = toupper(name[0]);
+    return "vertex" + name;
+}
+
+// swaps the declaration `in vec3 [inputName];` for the encoded vec2 input, plus a macro which decodes it,
+// so the body of the shader can carry on using `[inputName]` as a vec3.
+bool rewrite_octahedral_input(string& source, const string& inputName) {
+    regex declaration("(layout\\s*\\([^)]*\\)\\s*in\\s+)vec3(\\s+)" + inputName + "\\s*;");
+    smatch match;
+    if(!regex_search(source, match, declaration)) {
+        return false;
+    }
+    string encodedName = inputName + "Octahedral";
+    source.replace(match.position(), match.length(), format("{}vec2{}{};\n#define {} octahedralDecode({})",
+            match[1].str(), match[2].str(), encodedName, inputName, encodedName));
+
+    size_t offset = source.find(SHADER_INCLUDE_EXTENSION);
+    assert(offset != string::npos);
+    if(source.find("vec3 octahedralDecode(") == string::npos) {
+        source.insert(offset + strlen(SHADER_INCLUDE_EXTENSION), OCTAHEDRAL_DECODE);
+    }
+    return true;
+}
+
+// swaps the declaration `in mat4 modelMatrix;` for the compact transform input, which takes over its location,
+// plus macros which decode both the model matrix and (if there is one) the `in mat3 normalMatrix;` input from it.
+// the affine rows are the columns of a mat3x4, the position and scale then the rotation those of a mat2x4
+bool rewrite_instance_transform(string& source, InstanceTransform transform) {
+    regex modelDeclaration("(layout\\s*\\([^)]*\\)\\s*in\\s+)mat4(\\s+)modelMatrix\\s*;");
+    smatch match;
+    if(!regex_search(source, match, modelDeclaration)) {
+        return false;
+    }
+    bool affine = transform == InstanceTransform::AFFINE;
+    string encodedName = affine ? "modelMatrixAffine" : "modelMatrixTrs";
+    source.replace(match.position(), match.length(), format("{}{}{}{};\n#define modelMatrix {}",
+            match[1].str(), affine ? "mat3x4" : "mat2x4", match[2].str(), encodedName,
+            affine ? format("mat4(transpose({}))", encodedName) : format("trsModelMatrix({})", encodedName)));
+
+    regex normalDeclaration("layout\\s*\\([^)]*\\)\\s*in\\s+mat3\\s+normalMatrix\\s*;");
+    if(regex_search(source, match, normalDeclaration)) {
+        source.replace(match.position(), match.length(), format("#define normalMatrix {}NormalMatrix({})",
+                affine ? "affine" : "trs", encodedName));
+    }
+
+    size_t offset = source.find(SHADER_INCLUDE_EXTENSION);
+    assert(offset != string::npos);
+    source.insert(offset + strlen(SHADER_INCLUDE_EXTENSION), affine ? AFFINE_TRANSFORM_DECODE : TRS_TRANSFORM_DECODE);
+    return true;
+}
 
 int main(int argc, char *argv[]) {
     if(argc < 4) {
-        LOG_S(ERROR) << "not enough arguments, expecting: [name] [input_file_0] [input_file_1] [input_file_2] ... [output_file] (--defines [defines])";
+        LOG_S(ERROR) << "not enough arguments, expecting: [name] [input_file_0] [input_file_1] [input_file_2] ... [output_file] (--specialize [defines]) (--quantize [input]=[half|octahedral|unorm8];...) (--instance-transform [full|affine|trs]) (--asset-root [directory])";
         return 1;
     }
 
@@ -135,8 +229,7 @@ int main(int argc, char *argv[]) {
 
     vector<Shader> shaders;
     while(i < argc) {
-        if(strcmp("--specialize", argv[i]) == 0) {
-            i++;
+        if(strncmp("--", argv[i], 2) == 0) {
             break;
         }
         path p(argv[i++]);
@@ -151,13 +244,44 @@ int main(int argc, char *argv[]) {
     shaders.pop_back();
 
     vector<Definition> defines;
+    unordered_map<string, Quantization> quantizations;
+    InstanceTransform instanceTransform = InstanceTransform::FULL;
+    // shader keys are relative to this, like every other asset path
+    path assetRoot;
     while(i < argc) {
-        stringstream parts;
-        parts << argv[i];
-        for(string part; getline(parts, part, ';'); ) {
-            defines.push_back(Definition(part));
+        string option = argv[i++];
+        for(; i < argc && strncmp("--", argv[i], 2) != 0; i++) {
+            stringstream parts;
+            parts << argv[i];
+            for(string part; getline(parts, part, ';'); ) {
+                if(part.empty()) {
+                    continue;
+                }
+                if(option == "--specialize") {
+                    defines.push_back(Definition(part));
+                } else if(option == "--quantize") {
+                    size_t index = part.find('=');
+                    optional<Quantization> q = index == string::npos ? nullopt : parse_quantization(part.substr(index + 1));
+                    if(!q.has_value()) {
+                        LOG_S(ERROR) << "invalid quantization `" << part << "`, expecting [input]=[half|octahedral|unorm8]";
+                        return 1;
+                    }
+                    quantizations[part.substr(0, index)] = q.value();
+                } else if(option == "--instance-transform") {
+                    optional<InstanceTransform> t = parse_instance_transform(part);
+                    if(!t.has_value()) {
+                        LOG_S(ERROR) << "invalid instance transform `" << part << "`, expecting full, affine or trs";
+                        return 1;
+                    }
+                    instanceTransform = t.value();
+                } else if(option == "--asset-root") {
+                    assetRoot = part;
+                } else {
+                    LOG_S(ERROR) << "unknown option " << option;
+                    return 1;
+                }
+            }
         }
-        i++;
     }
 
     stringstream definitions;
@@ -238,7 +362,7 @@ int main(int argc, char *argv[]) {
         input.shaderObject->preprocess(&resources, clientVersion, EProfile::ECoreProfile, false, true, messages, &input.preprocessedSource, includer);
         size_t offset = input.preprocessedSource.find(INCLUDE_EXTENSION);
         //
-        input.preprocessedSource.replace(offset, strlen(INCLUDE_EXTENSION), "#extension GL_ARB_shading_language_include : enable");
+        input.preprocessedSource.replace(offset, strlen(INCLUDE_EXTENSION), SHADER_INCLUDE_EXTENSION);
 
         in.close();
     }
@@ -259,6 +383,26 @@ int main(int argc, char *argv[]) {
     result = program->buildReflection(EShReflectionAllBlockVariables | EShReflectionAllIOVariables);
     LOG_S(INFO) << "build reflection status: " << result;
 
+    // quantized inputs which need decoding are rewritten in the vertex shader source before it is emitted
+    for(auto& [name, quantization] : quantizations) {
+        if(quantization != Quantization::OCTAHEDRAL) {
+            continue;
+        }
+        auto vertexShader = std::find_if(shaders.begin(), shaders.end(), [](auto& s) { return s.shaderObject->getStage() == EShLangVertex; });
+        if(vertexShader == shaders.end() || !rewrite_octahedral_input(vertexShader->preprocessedSource, get_vertex_input_name(name))) {
+            LOG_S(ERROR) << "couldn't find a `vec3 " << get_vertex_input_name(name) << "` vertex input to quantize";
+            return 1;
+        }
+    }
+
+    if(instanceTransform != InstanceTransform::FULL) {
+        auto vertexShader = std::find_if(shaders.begin(), shaders.end(), [](auto& s) { return s.shaderObject->getStage() == EShLangVertex; });
+        if(vertexShader == shaders.end() || !rewrite_instance_transform(vertexShader->preprocessedSource, instanceTransform)) {
+            LOG_S(ERROR) << "couldn't find a `mat4 modelMatrix` instance input to encode";
+            return 1;
+        }
+    }
+
     LOG_S(INFO) << "opening output file " << output;
     ofstream out;
     out.open(output.replace_extension(".h"));
@@ -287,7 +431,12 @@ int main(int argc, char *argv[]) {
         out_impl << "const char* " << ty <<  "_SHADER = R\"\"(\n" << shader.preprocessedSource << ")\"\";\n";
 
         out << "struct " << toPascalCase(ty) << "Shader {\n";
-        out << "    string key = " << shader.filePath << ";\n";
+        string key = assetRoot.empty() ? shader.filePath.string() : relative(shader.filePath, assetRoot).generic_string();
+        // specialized variants of the same file mustn't share a cache entry
+        if(!defines.empty() || !quantizations.empty() || instanceTransform != InstanceTransform::FULL) {
+            key += "#" + name;
+        }
+        out << "    string key = " << quoted(key) << ";\n";
         out << "    string getKey() const;\n";
         out << "    shared_ptr<Shader> build(OpenGLContext& context);\n";
         out << "};\n";
@@ -344,6 +493,36 @@ int main(int argc, char *argv[]) {
         uniformBlocks.push_back(f);
     }
 
+    // shader storage blocks. a block holding nothing but a runtime sized array binds as a slice of its elements
+    vector<Field> storageBlocks;
+    for(int i = 0; i < program->getNumBufferBlocks(); i++) {
+        const glslang::TObjectReflection& block = program->getBufferBlock(i);
+        const glslang::TType* blockType = block.getType();
+        if(blockType->getQualifier().layoutPacking != glslang::TLayoutPacking::ElpStd430) {
+            LOG_S(ERROR) << "storage block `" << block.name << "` must be layout(std430)";
+            return 1;
+        }
+
+        Field f = {
+            .originalType = blockType,
+            .location = make_optional<int>(block.getBinding())
+        };
+        const glslang::TTypeList* members = blockType->getStruct();
+        if(members->size() == 1 && (*members)[0].type->isUnsizedArray()) {
+            const glslang::TType* array = (*members)[0].type;
+            glslang::TType elementType(*array, 0);
+            Type t = get_type(&elementType, AlignmentRequirements::STD430, defs);
+            f.name = string(array->getFieldName());
+            f.type = Type { .base = format("const BufferSlice<{}>", t.base), .numElements = nullopt };
+        } else {
+            Type t = get_type(blockType, AlignmentRequirements::STD430, defs);
+            f.name = block.name;
+            f.name[0] = tolower(f.name[0]);
+            f.type = Type { .base = format("const BufferView<{}>", t.base), .numElements = nullopt };
+        }
+        storageBlocks.push_back(f);
+    }
+
     // all non-block uniforms should be texture samplers.
     vector<Field> textures;
     for(int i = 0; i < program->getNumUniformVariables(); i++) {
@@ -364,9 +543,10 @@ int main(int argc, char *argv[]) {
 
     vector<Field> vertexInputs;
     vector<Field> instanceInputs;
+    bool isCompute = shaders.size() == 1 && shaders[0].shaderObject->getStage() == EShLangCompute;
 
     // vertex and instance inputs
-    for(int i = 0; i < program->getNumPipeInputs(); i++) {
+    for(int i = 0; i < program->getNumPipeInputs() && !isCompute; i++) {
         const glslang::TObjectReflection& input = program->getPipeInput(i);
 
         optional<Field> field = Field::create_from_pipe_input(input, defs);
@@ -376,6 +556,10 @@ int main(int argc, char *argv[]) {
             if(f.name.starts_with(prefix) && f.name.size() > prefix.size()) {
                 f.name = f.name.substr(prefix.size());
                 f.name[0] = tolower(f.name[0]);
+                auto q = quantizations.find(f.name);
+                if(q != quantizations.end() && !f.quantize(q->second)) {
+                    return 1;
+                }
                 vertexInputs.push_back(f);
             } else {
                 instanceInputs.push_back(f);
@@ -383,10 +567,25 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    // the compact transform replaces both matrices
+    if(instanceTransform != InstanceTransform::FULL) {
+        auto model = std::find_if(instanceInputs.begin(), instanceInputs.end(), [](auto& f) { return f.name == "modelMatrix"; });
+        if(model == instanceInputs.end() || !model->encodeTransform(instanceTransform)) {
+            return 1;
+        }
+        erase_if(instanceInputs, [](auto& f) { return f.name == "normalMatrix"; });
+    }
+
     for(auto& definition : defs) {
         out << definition;
     }
 
+    if(isCompute) {
+        out << "const uint32_t LOCAL_SIZE_X = " << program->getLocalSize(0) << ";\n";
+        out << "const uint32_t LOCAL_SIZE_Y = " << program->getLocalSize(1) << ";\n";
+        out << "const uint32_t LOCAL_SIZE_Z = " << program->getLocalSize(2) << ";\n";
+    }
+
     const char *VERTEX_INPUT_STRUCT = "VertexInput";
     const char *INSTANCE_INPUT_STRUCT = "InstanceInput";
     const char *VERTEX_INPUT_MEMBER_NAME = "perVertex";
@@ -394,64 +593,69 @@ int main(int argc, char *argv[]) {
     const int VERTEX_INPUT_BINDING = 0;
     const int INSTANCE_INPUT_BINDING = 1;
 
-    vector<Field> vertexBindings;
-    emit_struct(VERTEX_INPUT_STRUCT, AlignmentRequirements::C_DEFAULT, vertexInputs, [](auto o) {}, out);
-    vertexBindings.push_back({ .name = VERTEX_INPUT_MEMBER_NAME, .type = Type { .base = format("const VertexBufferBinding<{}>", VERTEX_INPUT_STRUCT), .numElements = nullopt }, .location = nullopt });
-    if(instanceInputs.size() > 0) {
-        emit_struct(INSTANCE_INPUT_STRUCT, AlignmentRequirements::C_DEFAULT, instanceInputs, [](auto o) {}, out);
-        vertexBindings.push_back({ .name = INSTANCE_INPUT_MEMBER_NAME, .type = Type { .base = format("const VertexBufferBinding<{}>", INSTANCE_INPUT_STRUCT), .numElements = nullopt }, .location = nullopt });
-    }
+    if(!isCompute) {
+        vector<Field> vertexBindings;
+        emit_struct(VERTEX_INPUT_STRUCT, AlignmentRequirements::C_DEFAULT, vertexInputs, [](auto o) {}, out);
+        vertexBindings.push_back({ .name = VERTEX_INPUT_MEMBER_NAME, .type = Type { .base = format("const VertexBufferBinding<{}>", VERTEX_INPUT_STRUCT), .numElements = nullopt }, .location = nullopt });
+        if(instanceInputs.size() > 0) {
+            emit_struct(INSTANCE_INPUT_STRUCT, AlignmentRequirements::C_DEFAULT, instanceInputs, [](auto o) {}, out);
+            vertexBindings.push_back({ .name = INSTANCE_INPUT_MEMBER_NAME, .type = Type { .base = format("const VertexBufferBinding<{}>", INSTANCE_INPUT_STRUCT), .numElements = nullopt }, .location = nullopt });
+        }
 
-    out << "struct VertexBindingPipelineState;\n";
-    out << "struct VertexBindingCreateInfo;\n";
+        out << "struct VertexBindingPipelineState;\n";
+        out << "struct VertexBindingCreateInfo;\n";
 
-    emit_struct("VertexBindings", AlignmentRequirements::C_DEFAULT, vertexBindings, [](auto out) {
-        *out << "    using CreateInfo = VertexBindingCreateInfo;\n";
-        *out << "    using PipelineState = VertexBindingPipelineState;\n";
-    }, out);
+        emit_struct("VertexBindings", AlignmentRequirements::C_DEFAULT, vertexBindings, [](auto out) {
+            *out << "    using CreateInfo = VertexBindingCreateInfo;\n";
+            *out << "    using PipelineState = VertexBindingPipelineState;\n";
+        }, out);
 
-    out << "struct VertexBindingPipelineState {\n";
-    out << "    void bindAll(const VertexBindings& bindings, BoundVertexArrayGuard& guard, OpenGLContext& context);\n";
-    out << "};\n";
+        out << "struct VertexBindingPipelineState {\n";
+        out << "    void bindAll(const VertexBindings& bindings, BoundVertexArrayGuard& guard, OpenGLContext& context);\n";
+        out << "};\n";
 
-    out_impl << "void VertexBindingPipelineState::bindAll(const VertexBindings& bindings, BoundVertexArrayGuard& guard, OpenGLContext& context) {\n";
-    out_impl << "    guard.bindVertexBuffer(" << VERTEX_INPUT_BINDING << ", bindings." << VERTEX_INPUT_MEMBER_NAME << ".buffer, bindings." << VERTEX_INPUT_MEMBER_NAME << ".byteOffset, sizeof(" << VERTEX_INPUT_STRUCT << "));\n";
-    if(instanceInputs.size() > 0) {
-        out_impl << "    guard.bindVertexBuffer(" << INSTANCE_INPUT_BINDING << ", bindings." << INSTANCE_INPUT_MEMBER_NAME
-            << ".buffer, bindings." << INSTANCE_INPUT_MEMBER_NAME << ".byteOffset, sizeof(" << INSTANCE_INPUT_STRUCT
-            << "));\n";
-    }
-    out_impl << "}\n";
+        out_impl << "void VertexBindingPipelineState::bindAll(const VertexBindings& bindings, BoundVertexArrayGuard& guard, OpenGLContext& context) {\n";
+        out_impl << "    guard.bindVertexBuffer(" << VERTEX_INPUT_BINDING << ", bindings." << VERTEX_INPUT_MEMBER_NAME << ".buffer, bindings." << VERTEX_INPUT_MEMBER_NAME << ".byteOffset, sizeof(" << VERTEX_INPUT_STRUCT << "));\n";
+        if(instanceInputs.size() > 0) {
+            out_impl << "    guard.bindVertexBuffer(" << INSTANCE_INPUT_BINDING << ", bindings." << INSTANCE_INPUT_MEMBER_NAME
+                << ".buffer, bindings." << INSTANCE_INPUT_MEMBER_NAME << ".byteOffset, sizeof(" << INSTANCE_INPUT_STRUCT
+                << "));\n";
+        }
+        out_impl << "}\n";
 
-    out << "struct VertexBindingCreateInfo {\n";
-    out << "    VertexBindingPipelineState init(VertexArray& array, OpenGLContext& context);\n";
-    out << "};\n";
+        out << "struct VertexBindingCreateInfo {\n";
+        out << "    VertexLayout getLayout() const;\n";
+        out << "    VertexBindingPipelineState init();\n";
+        out << "};\n";
 
-    out_impl << "VertexBindingPipelineState VertexBindingCreateInfo::init(VertexArray& array, OpenGLContext& context) {\n";
-    vector<VertexAttribute> attrs;
-    for(auto& vertexInput : vertexInputs) {
-        gather_attributes(vertexInput, VERTEX_INPUT_STRUCT, VERTEX_INPUT_BINDING, attrs);
-    }
-    for(auto& instanceInput : instanceInputs) {
-        gather_attributes(instanceInput, INSTANCE_INPUT_STRUCT, INSTANCE_INPUT_BINDING, attrs);
-    }
-    out_impl << "    context.withBoundVertexArray(array, [](auto guard) {\n";
-    write_attributes(attrs, out_impl);
+        out_impl << "VertexLayout VertexBindingCreateInfo::getLayout() const {\n";
+        vector<VertexAttribute> attrs;
+        for(auto& vertexInput : vertexInputs) {
+            gather_attributes(vertexInput, VERTEX_INPUT_STRUCT, VERTEX_INPUT_BINDING, attrs);
+        }
+        for(auto& instanceInput : instanceInputs) {
+            gather_attributes(instanceInput, INSTANCE_INPUT_STRUCT, INSTANCE_INPUT_BINDING, attrs);
+        }
+        vector<int> instancedBindings;
+        if(instanceInputs.size() > 0) {
+            instancedBindings.push_back(INSTANCE_INPUT_BINDING);
+        }
+        out_impl << "    return VertexLayout {\n";
+        write_vertex_layout(attrs, instancedBindings, out_impl);
+        out_impl << "    };\n";
+        out_impl << "}\n";
 
-    if(instanceInputs.size() > 0) {
-        out_impl << "        guard.setBindingDivisor(" << INSTANCE_INPUT_BINDING << ", 1);\n";
+        out_impl << "VertexBindingPipelineState VertexBindingCreateInfo::init() {\n";
+        out_impl << "    return VertexBindingPipelineState {};\n";
+        out_impl << "}\n";
     }
 
-    out_impl << "    });\n";
-
-    out_impl << "    return VertexBindingPipelineState {};\n";
-    out_impl << "}\n";
-
     out << "struct ResourceBindingPipelineState;\n";
     out << "struct ResourceBindingCreateInfo;\n";
 
     vector<Field> both;
     both.insert(both.end(), uniformBlocks.begin(), uniformBlocks.end());
+    both.insert(both.end(), storageBlocks.begin(), storageBlocks.end());
     both.insert(both.end(), textures.begin(), textures.end());
     emit_struct("ResourceBindings", AlignmentRequirements::C_DEFAULT, both, [](auto out) {
         *out << "    using CreateInfo = ResourceBindingCreateInfo;\n";
@@ -467,6 +671,9 @@ int main(int argc, char *argv[]) {
     for(auto& block : uniformBlocks) {
         out_impl << "    context.bindUniformBuffer(bindings." << block.name << ".buffer, " << block.location.value() << ", bindings." << block.name << ".byteOffset, sizeof(" << block.originalType->getTypeName() << "));\n";
     }
+    for(auto& block : storageBlocks) {
+        out_impl << "    context.bindStorageBuffer(bindings." << block.name << ".buffer, " << block.location.value() << ", bindings." << block.name << ".byteOffset, bindings." << block.name << ".getSize());\n";
+    }
     for(auto& tex : textures) {
         if(tex.type.numElements.has_value()) {
             out_impl << "    for(int i = 0; i < " << tex.type.numElements.value() << "; i++) {\n";
@@ -486,9 +693,15 @@ int main(int argc, char *argv[]) {
     out_impl << "    return ResourceBindingPipelineState {};\n";
     out_impl << "}\n";
 
-    out << "using Pipeline = GraphicsPipeline<VertexBindings, ResourceBindings>;\n";
-    out << "using Create = GraphicsPipelineCreateInfo<VertexBindings, ResourceBindings, Shaders>;\n";
-    out << "using DrawCmd = DrawCommand<VertexBindings, ResourceBindings>;\n";
+    if(isCompute) {
+        out << "using Pipeline = ComputePipeline<ResourceBindings>;\n";
+        out << "using Create = ComputePipelineCreateInfo<ResourceBindings, Shaders>;\n";
+        out << "using DispatchCmd = DispatchCommand<ResourceBindings>;\n";
+    } else {
+        out << "using Pipeline = GraphicsPipeline<VertexBindings, ResourceBindings>;\n";
+        out << "using Create = GraphicsPipelineCreateInfo<VertexBindings, ResourceBindings, Shaders>;\n";
+        out << "using DrawCmd = DrawCommand<VertexBindings, ResourceBindings>;\n";
+    }
 
     delete program;
 
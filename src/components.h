@@ -0,0 +1,54 @@
+#ifndef GAME_ENGINE_COMPONENTS_H
+#define GAME_ENGINE_COMPONENTS_H
+
+#include <memory>
+#include <glm/glm.hpp>
+#include "culling.h"
+#include "scene.h"
+#include "graphics/texturing.h"
+#include "loader/models.h"
+
+using namespace std;
+
+// components of renderable entities, see `World`
+
+// world space, copied from whatever owns the entity's transform (see below) once per frame
+struct TransformComponent {
+    glm::mat4 modelMatrix = glm::mat4(1.0f);
+};
+
+// the transform comes from slot `index` of an instanced batch's `TransformArray`, which is also its item in the `Bvh`
+struct InstanceComponent {
+    uint32_t index;
+};
+
+// the transform comes from a node of the `SceneGraph`
+struct SceneNodeComponent {
+    SceneNode node;
+};
+
+struct MeshComponent {
+    ModelBufferSlices slices;
+    BoundingBox localBounds;
+};
+
+struct MaterialComponent {
+    shared_ptr<Texture2d> texture;
+    // the distance the texture spans across the mesh, for choosing which mip levels to stream in
+    float textureWorldSize;
+    // none means the surface is flat
+    shared_ptr<Texture2d> normalMap;
+};
+
+struct BoundsComponent {
+    BoundingBox world;
+};
+
+struct LodComponent {
+    float distance = 0.0f;
+    float mipLevel = 0.0f;
+    // in the camera's frustum
+    bool visible = false;
+};
+
+#endif //GAME_ENGINE_COMPONENTS_H
@@ -0,0 +1,152 @@
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+#include <lz4.h>
+
+#define LOGURU_WITH_STREAMS 1
+#include <loguru/loguru.hpp>
+
+#include "../loader/archive.h"
+#include "../parallel.h"
+
+using namespace std;
+using namespace std::filesystem;
+
+// below this many blocks it isn't worth handing a file to other threads
+const size_t BLOCKS_GRAIN = 4;
+
+struct PackedFileInfo {
+    string key;
+    path source;
+};
+
+// compresses every block of `data`, in parallel. blocks which don't shrink are kept as they are
+vector<vector<char>> compressBlocks(const vector<char>& data, uint32_t blockSize) {
+    size_t numBlocks = (data.size() + blockSize - 1) / blockSize;
+    vector<vector<char>> blocks(numBlocks);
+
+    parallelForRanges(numBlocks, BLOCKS_GRAIN, [&](size_t begin, size_t end) {
+        for(size_t block = begin; block < end; block++) {
+            const char* source = data.data() + block * blockSize;
+            int size = min<size_t>(blockSize, data.size() - block * blockSize);
+
+            vector<char>& compressed = blocks[block];
+            compressed.resize(LZ4_compressBound(size));
+            int compressedSize = LZ4_compress_default(source, compressed.data(), size, compressed.size());
+            if(compressedSize <= 0 || compressedSize >= size) {
+                compressed.assign(source, source + size);
+            } else {
+                compressed.resize(compressedSize);
+            }
+        }
+    });
+
+    return blocks;
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 3) {
+        LOG_S(ERROR) << "expecting: [output_archive] [input_directory | prefix=input_directory] ...";
+        return 1;
+    }
+
+    const char* output = argv[1];
+
+    // later directories replace files with the same key from earlier ones
+    unordered_map<string, path> sources;
+    for(int i = 2; i < argc; i++) {
+        string argument = argv[i];
+        string prefix;
+        size_t separator = argument.find('=');
+        if(separator != string::npos) {
+            prefix = argument.substr(0, separator);
+            argument = argument.substr(separator + 1);
+        }
+
+        path directory(argument);
+        if(!is_directory(directory)) {
+            LOG_S(ERROR) << directory << " is not a directory";
+            return 1;
+        }
+        for(auto& file : recursive_directory_iterator(directory)) {
+            if(file.is_regular_file()) {
+                sources[prefix + relative(file.path(), directory).generic_string()] = file.path();
+            }
+        }
+    }
+
+    vector<PackedFileInfo> files;
+    for(auto& [key, source] : sources) {
+        files.push_back(PackedFileInfo { .key = key, .source = source });
+    }
+    // the runtime binary searches the entries by hash
+    sort(files.begin(), files.end(), [](auto& a, auto& b) {
+        return hashAssetPath(a.key) < hashAssetPath(b.key);
+    });
+
+    ofstream archive(output, ios::binary | ios::trunc);
+    AssetArchiveHeader header {
+        .version = ASSET_ARCHIVE_VERSION,
+        .blockSize = ASSET_ARCHIVE_BLOCK_SIZE,
+        .numEntries = static_cast<uint32_t>(files.size())
+    };
+    memcpy(header.magic, ASSET_ARCHIVE_MAGIC, sizeof(header.magic));
+    // written again at the end, once the offsets are known
+    archive.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    vector<AssetArchiveBlock> blocks;
+    vector<AssetArchiveEntry> entries;
+    string paths;
+    size_t totalBytes = 0;
+    for(auto& file : files) {
+        ifstream input(file.source, ios::binary | ios::ate);
+        vector<char> data(input.tellg());
+        input.seekg(0);
+        if(!input.read(data.data(), data.size())) {
+            LOG_S(ERROR) << "couldn't read " << file.source;
+            return 1;
+        }
+
+        entries.push_back(AssetArchiveEntry {
+            .pathHash = hashAssetPath(file.key),
+            .size = data.size(),
+            .firstBlock = static_cast<uint32_t>(blocks.size()),
+            .numBlocks = static_cast<uint32_t>((data.size() + ASSET_ARCHIVE_BLOCK_SIZE - 1) / ASSET_ARCHIVE_BLOCK_SIZE),
+            .pathOffset = static_cast<uint32_t>(paths.size()),
+            .pathLength = static_cast<uint32_t>(file.key.size())
+        });
+        paths += file.key;
+
+        for(auto& compressed : compressBlocks(data, ASSET_ARCHIVE_BLOCK_SIZE)) {
+            blocks.push_back(AssetArchiveBlock {
+                .byteOffset = static_cast<uint64_t>(archive.tellp()),
+                .compressedSize = static_cast<uint32_t>(compressed.size())
+            });
+            archive.write(compressed.data(), compressed.size());
+        }
+        totalBytes += data.size();
+    }
+
+    header.numBlocks = blocks.size();
+    header.blockTableOffset = archive.tellp();
+    archive.write(reinterpret_cast<const char*>(blocks.data()), sizeof(AssetArchiveBlock) * blocks.size());
+    header.entryTableOffset = archive.tellp();
+    archive.write(reinterpret_cast<const char*>(entries.data()), sizeof(AssetArchiveEntry) * entries.size());
+    header.pathTableOffset = archive.tellp();
+    archive.write(paths.data(), paths.size());
+    size_t archiveBytes = archive.tellp();
+
+    archive.seekp(0);
+    archive.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if(!archive.good()) {
+        LOG_S(ERROR) << "couldn't write " << output;
+        return 1;
+    }
+
+    LOG_S(INFO) << "packed " << files.size() << " files (" << totalBytes << " bytes) into " << archiveBytes << " bytes";
+    return 0;
+}
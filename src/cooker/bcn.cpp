@@ -0,0 +1,155 @@
+#include "bcn.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+static uint16_t packRGB565(const int rgb[3]) {
+    int r = (rgb[0] * 31 + 127) / 255;
+    int g = (rgb[1] * 63 + 127) / 255;
+    int b = (rgb[2] * 31 + 127) / 255;
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void unpackRGB565(uint16_t color, int rgb[3]) {
+    int r = (color >> 11) & 31;
+    int g = (color >> 5) & 63;
+    int b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+static void writeLittleEndian(uint8_t* out, uint64_t value, int numBytes) {
+    for(int i = 0; i < numBytes; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void encodeBC1Block(const uint8_t* rgba, uint8_t* out) {
+    int minColor[3] = {255, 255, 255};
+    int maxColor[3] = {0, 0, 0};
+    int mean[3] = {0, 0, 0};
+    for(int i = 0; i < 16; i++) {
+        for(int c = 0; c < 3; c++) {
+            minColor[c] = std::min<int>(minColor[c], rgba[i * 4 + c]);
+            maxColor[c] = std::max<int>(maxColor[c], rgba[i * 4 + c]);
+            mean[c] += rgba[i * 4 + c];
+        }
+    }
+
+    // the bounding box has four diagonals, pick the one along which the colours correlate
+    // with the channel of largest extent
+    int mainChannel = 0;
+    for(int c = 1; c < 3; c++) {
+        if(maxColor[c] - minColor[c] > maxColor[mainChannel] - minColor[mainChannel]) {
+            mainChannel = c;
+        }
+    }
+    for(int c = 0; c < 3; c++) {
+        if(c == mainChannel) {
+            continue;
+        }
+        int covariance = 0;
+        for(int i = 0; i < 16; i++) {
+            covariance += (rgba[i * 4 + mainChannel] * 16 - mean[mainChannel]) * (rgba[i * 4 + c] * 16 - mean[c]);
+        }
+        if(covariance < 0) {
+            std::swap(minColor[c], maxColor[c]);
+        }
+    }
+
+    // inset the endpoints slightly, which lowers the error for the texels in between
+    for(int c = 0; c < 3; c++) {
+        int inset = (maxColor[c] - minColor[c]) / 16;
+        maxColor[c] -= inset;
+        minColor[c] += inset;
+    }
+
+    uint16_t color0 = packRGB565(maxColor);
+    uint16_t color1 = packRGB565(minColor);
+    // color0 > color1 selects the four colour mode, which has no transparent entry
+    if(color0 < color1) {
+        std::swap(color0, color1);
+    }
+
+    uint32_t indices = 0;
+    if(color0 != color1) {
+        int palette[4][3];
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        for(int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for(int i = 0; i < 16; i++) {
+            int bestIndex = 0;
+            int bestDistance = 1 << 30;
+            for(int p = 0; p < 4; p++) {
+                int distance = 0;
+                for(int c = 0; c < 3; c++) {
+                    int d = rgba[i * 4 + c] - palette[p][c];
+                    distance += d * d;
+                }
+                if(distance < bestDistance) {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(bestIndex) << (2 * i);
+        }
+    }
+
+    writeLittleEndian(out, color0, 2);
+    writeLittleEndian(out + 2, color1, 2);
+    writeLittleEndian(out + 4, indices, 4);
+}
+
+void encodeBC4Block(const uint8_t* rgba, int channel, uint8_t* out) {
+    int minValue = 255;
+    int maxValue = 0;
+    for(int i = 0; i < 16; i++) {
+        minValue = std::min<int>(minValue, rgba[i * 4 + channel]);
+        maxValue = std::max<int>(maxValue, rgba[i * 4 + channel]);
+    }
+
+    uint64_t indices = 0;
+    if(maxValue != minValue) {
+        // value0 > value1 selects the mode with six interpolated values
+        int palette[8];
+        palette[0] = maxValue;
+        palette[1] = minValue;
+        for(int p = 2; p < 8; p++) {
+            palette[p] = ((8 - p) * maxValue + (p - 1) * minValue + 3) / 7;
+        }
+
+        for(int i = 0; i < 16; i++) {
+            int value = rgba[i * 4 + channel];
+            int bestIndex = 0;
+            int bestDistance = 256;
+            for(int p = 0; p < 8; p++) {
+                int distance = std::abs(value - palette[p]);
+                if(distance < bestDistance) {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+            indices |= static_cast<uint64_t>(bestIndex) << (3 * i);
+        }
+    }
+
+    out[0] = static_cast<uint8_t>(maxValue);
+    out[1] = static_cast<uint8_t>(minValue);
+    writeLittleEndian(out + 2, indices, 6);
+}
+
+void encodeBC3Block(const uint8_t* rgba, uint8_t* out) {
+    encodeBC4Block(rgba, 3, out);
+    encodeBC1Block(rgba, out + 8);
+}
+
+void encodeBC5Block(const uint8_t* rgba, uint8_t* out) {
+    encodeBC4Block(rgba, 0, out);
+    encodeBC4Block(rgba, 1, out + 8);
+}
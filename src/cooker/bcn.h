@@ -0,0 +1,19 @@
+#ifndef GAME_ENGINE_BCN_H
+#define GAME_ENGINE_BCN_H
+
+#include <cstdint>
+
+// block compression encoders. each takes one 4x4 block of RGBA8 texels (row major,
+// 64 bytes) and writes a single compressed block. endpoints are picked from the
+// (inset) bounding box of the block, which is fast and good enough for most content.
+
+// 8 bytes, ignores alpha
+void encodeBC1Block(const uint8_t* rgba, uint8_t* out);
+// 16 bytes, BC4 encoded alpha followed by a BC1 colour block
+void encodeBC3Block(const uint8_t* rgba, uint8_t* out);
+// 8 bytes, from the given channel (0 = red ... 3 = alpha)
+void encodeBC4Block(const uint8_t* rgba, int channel, uint8_t* out);
+// 16 bytes, the red and green channels as two BC4 blocks
+void encodeBC5Block(const uint8_t* rgba, uint8_t* out);
+
+#endif //GAME_ENGINE_BCN_H
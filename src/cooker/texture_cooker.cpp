@@ -0,0 +1,126 @@
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+#define LOGURU_WITH_STREAMS 1
+#include <loguru/loguru.hpp>
+
+#include "../loader/stb_image.h"
+#include "../loader/cooked_texture.h"
+#include "../loader/mipmaps.h"
+#include "../parallel.h"
+#include "bcn.h"
+
+using namespace std;
+
+// below this many block rows it isn't worth handing a level to other threads
+const size_t BLOCK_ROWS_GRAIN = 16;
+
+// always RGBA8
+struct Image {
+    uint32_t width;
+    uint32_t height;
+    const uint8_t* pixels;
+
+    const uint8_t* texel(uint32_t x, uint32_t y) const {
+        return &pixels[(min(y, height - 1) * width + min(x, width - 1)) * 4];
+    }
+};
+
+void encodeBlock(CookedFormat format, const uint8_t* rgba, uint8_t* out) {
+    switch(format) {
+        case CookedFormat::BC1_RGB:
+            encodeBC1Block(rgba, out);
+            break;
+        case CookedFormat::BC3_RGBA:
+            encodeBC3Block(rgba, out);
+            break;
+        case CookedFormat::BC4_R:
+            encodeBC4Block(rgba, 0, out);
+            break;
+        case CookedFormat::BC5_RG:
+            encodeBC5Block(rgba, out);
+            break;
+    }
+}
+
+// appends the compressed level to `texture`. rows of blocks are encoded in parallel
+void encodeLevel(const Image& image, CookedTexture& texture) {
+    size_t blockSize = cookedFormatBlockSize(texture.format);
+    uint32_t blocksX = (image.width + 3) / 4;
+    uint32_t blocksY = (image.height + 3) / 4;
+
+    CookedMipLevel level {
+        .width = image.width,
+        .height = image.height,
+        .byteOffset = texture.data.size(),
+        .byteSize = blocksX * blocksY * blockSize
+    };
+    texture.data.resize(level.byteOffset + level.byteSize);
+    uint8_t* out = texture.data.data() + level.byteOffset;
+
+    parallelForRanges(blocksY, BLOCK_ROWS_GRAIN, [&](size_t begin, size_t end) {
+        uint8_t block[16 * 4];
+        for(uint32_t by = begin; by < end; by++) {
+            for(uint32_t bx = 0; bx < blocksX; bx++) {
+                // blocks hanging over the edge repeat the last row/column
+                for(uint32_t y = 0; y < 4; y++) {
+                    for(uint32_t x = 0; x < 4; x++) {
+                        memcpy(&block[(y * 4 + x) * 4], image.texel(bx * 4 + x, by * 4 + y), 4);
+                    }
+                }
+                encodeBlock(texture.format, block, out + (by * blocksX + bx) * blockSize);
+            }
+        }
+    });
+
+    texture.levels.push_back(level);
+}
+
+int main(int argc, char *argv[]) {
+    unordered_map<string, pair<CookedFormat, ColorSpace>> modes = {
+        {"color", {CookedFormat::BC1_RGB, ColorSpace::SRGB}},
+        {"color_alpha", {CookedFormat::BC3_RGBA, ColorSpace::SRGB}},
+        {"gray", {CookedFormat::BC4_R, ColorSpace::LINEAR}},
+        {"normal", {CookedFormat::BC5_RG, ColorSpace::LINEAR}}
+    };
+
+    if(argc != 4 || !modes.contains(argv[3])) {
+        LOG_S(ERROR) << "expecting: [input_image] [output" << COOKED_TEXTURE_EXTENSION << "] [color|color_alpha|gray|normal]";
+        return 1;
+    }
+
+    const char* input = argv[1];
+    const char* output = argv[2];
+    auto [format, colorSpace] = modes[argv[3]];
+
+    int x, y, n;
+    unsigned char *data = stbi_load(input, &x, &y, &n, 4);
+    if(data == nullptr) {
+        LOG_S(ERROR) << "couldn't load " << input << ": " << stbi_failure_reason();
+        return 1;
+    }
+
+    CookedTexture texture {
+        .format = format,
+        .width = static_cast<uint32_t>(x),
+        .height = static_cast<uint32_t>(y)
+    };
+
+    // the full chain down to 1x1, matching `OpenGLContext::buildTexture2D`
+    encodeLevel(Image { .width = texture.width, .height = texture.height, .pixels = data }, texture);
+    for(auto& level : generateMipLevels(data, texture.width, texture.height, 4, colorSpace)) {
+        encodeLevel(Image { .width = level.width, .height = level.height, .pixels = level.pixels.data() }, texture);
+    }
+    stbi_image_free(data);
+
+    if(!writeCookedTexture(output, texture)) {
+        LOG_S(ERROR) << "couldn't write " << output;
+        return 1;
+    }
+
+    LOG_S(INFO) << "cooked " << input << " (" << x << "x" << y << ", " << texture.levels.size() << " levels) into " << texture.data.size() << " bytes";
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "culling.h"
+
+void BoundingBox::extend(glm::vec3 point) {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void BoundingBox::extend(const BoundingBox &other) {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+bool BoundingBox::isEmpty() const {
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+glm::vec3 BoundingBox::getCenter() const {
+    return (min + max) * 0.5f;
+}
+
+glm::vec3 BoundingBox::getExtent() const {
+    return (max - min) * 0.5f;
+}
+
+float BoundingBox::getSurfaceArea() const {
+    if(isEmpty()) {
+        return 0.0f;
+    }
+    glm::vec3 size = max - min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+BoundingBox BoundingBox::transform(const glm::mat4 &matrix) const {
+    // Arvo's method: the extent along each world axis is the sum of the absolute projections of the local axes
+    glm::vec3 center = glm::vec3(matrix * glm::vec4(getCenter(), 1.0f));
+    glm::vec3 extent = getExtent();
+    glm::vec3 worldExtent = glm::abs(glm::vec3(matrix[0])) * extent.x
+            + glm::abs(glm::vec3(matrix[1])) * extent.y
+            + glm::abs(glm::vec3(matrix[2])) * extent.z;
+    return BoundingBox { .min = center - worldExtent, .max = center + worldExtent };
+}
+
+Frustum Frustum::fromViewProjection(const glm::mat4 &viewProjection) {
+    // glm is column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&](int i) {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+    glm::vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+    return Frustum {
+        .planes = { w + x, w - x, w + y, w - y, w + z, w - z }
+    };
+}
+
+bool Frustum::intersects(const BoundingBox &box) const {
+    glm::vec3 center = box.getCenter();
+    glm::vec3 extent = box.getExtent();
+    for(const glm::vec4& plane : planes) {
+        glm::vec3 normal = glm::vec3(plane);
+        // the box is fully outside if even its corner furthest along the normal is behind the plane
+        float radius = glm::dot(glm::abs(normal), extent);
+        if(glm::dot(normal, center) + plane.w + radius < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Containment Frustum::classify(const BoundingBox &box) const {
+    glm::vec3 center = box.getCenter();
+    glm::vec3 extent = box.getExtent();
+    Containment result = Containment::INSIDE;
+    for(const glm::vec4& plane : planes) {
+        glm::vec3 normal = glm::vec3(plane);
+        float radius = glm::dot(glm::abs(normal), extent);
+        float distance = glm::dot(normal, center) + plane.w;
+        if(distance + radius < 0.0f) {
+            return Containment::OUTSIDE;
+        }
+        if(distance - radius < 0.0f) {
+            result = Containment::INTERSECTING;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,45 @@
+#ifndef GAME_ENGINE_CULLING_H
+#define GAME_ENGINE_CULLING_H
+
+#include <limits>
+#include <glm/glm.hpp>
+
+using namespace std;
+
+// axis aligned
+struct BoundingBox {
+    glm::vec3 min = glm::vec3(numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(numeric_limits<float>::lowest());
+
+    void extend(glm::vec3 point);
+    void extend(const BoundingBox& other);
+    bool isEmpty() const;
+    glm::vec3 getCenter() const;
+    glm::vec3 getExtent() const;
+    float getSurfaceArea() const;
+    // the smallest box containing this one after being transformed by `matrix`
+    BoundingBox transform(const glm::mat4& matrix) const;
+};
+
+enum class Containment {
+    OUTSIDE,
+    INTERSECTING,
+    INSIDE
+};
+
+// the six planes of a view frustum, pointing inwards. planes aren't normalized, which doesn't matter for
+// inside/outside tests but does for distances
+struct Frustum {
+    // left, right, bottom, top, near, far as (normal, distance)
+    glm::vec4 planes[6];
+
+    // Gribb & Hartmann: combinations of the rows of the view projection matrix, with OpenGL's [-w, w] clip space
+    static Frustum fromViewProjection(const glm::mat4& viewProjection);
+
+    // conservative, boxes near the corners of the frustum may be counted as intersecting when they aren't
+    bool intersects(const BoundingBox& box) const;
+    // also conservative, but tells apart boxes which are entirely inside
+    Containment classify(const BoundingBox& box) const;
+};
+
+#endif //GAME_ENGINE_CULLING_H
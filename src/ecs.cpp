@@ -0,0 +1,168 @@
+#include "ecs.h"
+
+#include <atomic>
+
+static size_t alignUp(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+ComponentId allocateComponentId() {
+    static atomic<ComponentId> nextId = 0;
+    ComponentId id = nextId++;
+    assert(id < ECS_MAX_COMPONENTS);
+    return id;
+}
+
+static ComponentMask maskOf(const vector<const ComponentType*>& types) {
+    ComponentMask mask;
+    for(auto type : types) {
+        mask.set(type->id);
+    }
+    return mask;
+}
+
+Archetype::Archetype(vector<const ComponentType*> types)
+        : columns(ECS_MAX_COMPONENTS, -1), mask(maskOf(types)), types(std::move(types)) {
+    size_t rowBytes = sizeof(Entity);
+    for(size_t i = 0; i < this->types.size(); i++) {
+        columns[this->types[i]->id] = i;
+        rowBytes += this->types[i]->size;
+    }
+
+    // as many rows as fit, less a few if padding between the arrays pushes them over
+    for(capacity = ECS_CHUNK_BYTES / rowBytes; capacity > 0; capacity--) {
+        offsets.clear();
+        size_t offset = sizeof(Entity) * capacity;
+        for(auto type : this->types) {
+            offset = alignUp(offset, type->alignment);
+            offsets.push_back(offset);
+            offset += type->size * capacity;
+        }
+        if(offset <= ECS_CHUNK_BYTES) {
+            break;
+        }
+    }
+    assert(capacity > 0);
+}
+
+Archetype::~Archetype() {
+    for(auto& chunk : chunks) {
+        for(size_t i = 0; i < types.size(); i++) {
+            for(uint32_t row = 0; row < chunk->count; row++) {
+                types[i]->destroy(chunk->data + offsets[i] + row * types[i]->size);
+            }
+        }
+    }
+}
+
+Entity *Archetype::getEntities(Chunk &chunk) const {
+    return reinterpret_cast<Entity*>(chunk.data);
+}
+
+void *Archetype::getColumn(Chunk &chunk, ComponentId id) const {
+    assert(columns[id] >= 0);
+    return chunk.data + offsets[columns[id]];
+}
+
+void *Archetype::getComponent(Chunk &chunk, uint32_t row, ComponentId id) const {
+    return static_cast<byte*>(getColumn(chunk, id)) + row * types[columns[id]]->size;
+}
+
+Archetype &World::getArchetype(vector<const ComponentType*> types) {
+    ComponentMask mask = maskOf(types);
+    auto found = archetypesByMask.find(mask);
+    if(found != archetypesByMask.end()) {
+        return *found->second;
+    }
+    sort(types.begin(), types.end(), [](auto a, auto b) { return a->id < b->id; });
+    archetypes.push_back(make_unique<Archetype>(std::move(types)));
+    archetypesByMask[mask] = archetypes.back().get();
+    return *archetypes.back();
+}
+
+Entity World::allocateEntity() {
+    if(!freeEntities.empty()) {
+        uint32_t index = freeEntities.back();
+        freeEntities.pop_back();
+        return Entity { .index = index, .generation = entities[index].generation };
+    }
+    entities.push_back(EntityRecord {});
+    return Entity { .index = static_cast<uint32_t>(entities.size() - 1), .generation = 0 };
+}
+
+void World::allocateRow(Archetype &archetype, Entity entity) {
+    if(archetype.chunks.empty() || archetype.chunks.back()->count == archetype.capacity) {
+        archetype.chunks.push_back(make_unique<Chunk>());
+    }
+    Chunk& chunk = *archetype.chunks.back();
+    uint32_t row = chunk.count++;
+    new (archetype.getEntities(chunk) + row) Entity(entity);
+    EntityRecord& record = entities[entity.index];
+    record.archetype = &archetype;
+    record.chunk = archetype.chunks.size() - 1;
+    record.row = row;
+}
+
+void World::removeRow(const EntityRecord &record) {
+    Archetype& archetype = *record.archetype;
+    Chunk& chunk = *archetype.chunks[record.chunk];
+    Chunk& lastChunk = *archetype.chunks.back();
+    uint32_t lastRow = lastChunk.count - 1;
+    bool isLast = &chunk == &lastChunk && record.row == lastRow;
+
+    for(size_t i = 0; i < archetype.types.size(); i++) {
+        const ComponentType& type = *archetype.types[i];
+        void* component = archetype.getComponent(chunk, record.row, type.id);
+        type.destroy(component);
+        if(!isLast) {
+            void* last = archetype.getComponent(lastChunk, lastRow, type.id);
+            type.moveConstruct(component, last);
+            type.destroy(last);
+        }
+    }
+    if(!isLast) {
+        Entity moved = archetype.getEntities(lastChunk)[lastRow];
+        archetype.getEntities(chunk)[record.row] = moved;
+        entities[moved.index].chunk = record.chunk;
+        entities[moved.index].row = record.row;
+    }
+
+    lastChunk.count--;
+    if(lastChunk.count == 0) {
+        archetype.chunks.pop_back();
+    }
+}
+
+void World::moveToArchetype(Entity entity, Archetype &destination) {
+    EntityRecord source = entities[entity.index];
+    allocateRow(destination, entity);
+    const EntityRecord& moved = entities[entity.index];
+    Chunk& sourceChunk = *source.archetype->chunks[source.chunk];
+    Chunk& destinationChunk = *destination.chunks[moved.chunk];
+    for(auto type : source.archetype->types) {
+        if(destination.mask.test(type->id)) {
+            type->moveConstruct(destination.getComponent(destinationChunk, moved.row, type->id),
+                    source.archetype->getComponent(sourceChunk, source.row, type->id));
+        }
+    }
+    // destroys what was moved from, and any component the destination doesn't have
+    removeRow(source);
+}
+
+void World::destroy(Entity entity) {
+    assert(isAlive(entity));
+    EntityRecord& record = entities[entity.index];
+    removeRow(record);
+    record.archetype = nullptr;
+    record.generation++;
+    freeEntities.push_back(entity.index);
+}
+
+bool World::isAlive(Entity entity) const {
+    return entity.index < entities.size() && entities[entity.index].archetype != nullptr
+            && entities[entity.index].generation == entity.generation;
+}
+
+size_t World::size() const {
+    return entities.size() - freeEntities.size();
+}
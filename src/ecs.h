@@ -0,0 +1,232 @@
+#ifndef GAME_ENGINE_ECS_H
+#define GAME_ENGINE_ECS_H
+
+#include <span>
+#include <bitset>
+#include <new>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <unordered_map>
+#include <type_traits>
+#include "jobs.h"
+
+using namespace std;
+
+// every chunk is this big, whichever components it holds
+const size_t ECS_CHUNK_BYTES = 16 * 1024;
+// distinct component types in one program
+const size_t ECS_MAX_COMPONENTS = 64;
+
+using ComponentId = uint32_t;
+using ComponentMask = bitset<ECS_MAX_COMPONENTS>;
+
+struct Entity {
+    uint32_t index;
+    // bumped when the index is reused, so stale entities are told apart from the new one
+    uint32_t generation;
+
+    bool operator==(const Entity& other) const = default;
+};
+
+// how to move and destroy a component without knowing its type
+struct ComponentType {
+    ComponentId id;
+    size_t size;
+    size_t alignment;
+    void (*moveConstruct)(void* destination, void* source);
+    void (*destroy)(void* component);
+};
+
+ComponentId allocateComponentId();
+
+template<typename T>
+const ComponentType& getComponentType() {
+    static_assert(!is_const_v<T> && !is_reference_v<T>);
+    static const ComponentType type {
+        .id = allocateComponentId(),
+        .size = sizeof(T),
+        .alignment = alignof(T),
+        .moveConstruct = [](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); },
+        .destroy = [](void* component) { static_cast<T*>(component)->~T(); }
+    };
+    return type;
+}
+
+// entities, then one array per component, each `capacity` long
+struct alignas(64) Chunk {
+    byte data[ECS_CHUNK_BYTES];
+    uint32_t count = 0;
+};
+
+// every entity with exactly the same set of components. they're packed into chunks, all of which are full
+// except the last one, so removing an entity moves the archetype's last one into its place
+class Archetype {
+    vector<int> columns;
+
+public:
+    const ComponentMask mask;
+    // sorted by id
+    const vector<const ComponentType*> types;
+    vector<size_t> offsets;
+    uint32_t capacity;
+    vector<unique_ptr<Chunk>> chunks;
+
+    explicit Archetype(vector<const ComponentType*> types);
+    ~Archetype();
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+
+    Entity* getEntities(Chunk& chunk) const;
+    // the array of component `id`, which this archetype must have
+    void* getColumn(Chunk& chunk, ComponentId id) const;
+    void* getComponent(Chunk& chunk, uint32_t row, ComponentId id) const;
+};
+
+// entities and their components, stored by archetype in chunks of SoA arrays so iterating over a few
+// components of many entities only reads those components' arrays. adding or removing a component
+// moves the entity to another archetype, which is much slower than changing a component's value,
+// and isn't allowed while iterating.
+class World {
+    struct EntityRecord {
+        Archetype* archetype = nullptr;
+        uint32_t chunk = 0;
+        uint32_t row = 0;
+        uint32_t generation = 0;
+    };
+
+    vector<EntityRecord> entities;
+    vector<uint32_t> freeEntities;
+    vector<unique_ptr<Archetype>> archetypes;
+    unordered_map<ComponentMask, Archetype*> archetypesByMask;
+
+    Archetype& getArchetype(vector<const ComponentType*> types);
+    Entity allocateEntity();
+    // reserves a row at the end of `archetype` for `entity`, its components still have to be constructed
+    void allocateRow(Archetype& archetype, Entity entity);
+    // destroys the components of `entity`'s row and fills the hole with the last row of its archetype
+    void removeRow(const EntityRecord& record);
+    // moves `entity`'s components to a new row in `destination`, except those it doesn't have
+    void moveToArchetype(Entity entity, Archetype& destination);
+
+    template<typename... C>
+    static ComponentMask getMask() {
+        ComponentMask mask;
+        (mask.set(getComponentType<remove_const_t<C>>().id), ...);
+        return mask;
+    }
+
+    template<typename... C>
+    vector<pair<Archetype*, Chunk*>> getChunks() {
+        ComponentMask required = getMask<C...>();
+        vector<pair<Archetype*, Chunk*>> matching;
+        for(auto& archetype : archetypes) {
+            if((archetype->mask & required) != required) {
+                continue;
+            }
+            for(auto& chunk : archetype->chunks) {
+                matching.emplace_back(archetype.get(), chunk.get());
+            }
+        }
+        return matching;
+    }
+
+    template<typename... C, typename F>
+    static void visitChunk(Archetype& archetype, Chunk& chunk, F& callback) {
+        callback(span<const Entity>(archetype.getEntities(chunk), chunk.count),
+                span<C>(static_cast<C*>(archetype.getColumn(chunk, getComponentType<remove_const_t<C>>().id)), chunk.count)...);
+    }
+
+public:
+    World() = default;
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    template<typename... C>
+    Entity create(C... components) {
+        Archetype& archetype = getArchetype({ &getComponentType<C>()... });
+        Entity entity = allocateEntity();
+        allocateRow(archetype, entity);
+        const EntityRecord& record = entities[entity.index];
+        Chunk& chunk = *archetype.chunks[record.chunk];
+        (new (archetype.getComponent(chunk, record.row, getComponentType<C>().id)) C(std::move(components)), ...);
+        return entity;
+    }
+
+    void destroy(Entity entity);
+    bool isAlive(Entity entity) const;
+
+    template<typename C>
+    bool has(Entity entity) const {
+        assert(isAlive(entity));
+        return entities[entity.index].archetype->mask.test(getComponentType<C>().id);
+    }
+
+    template<typename C>
+    C& get(Entity entity) {
+        assert(has<C>(entity));
+        const EntityRecord& record = entities[entity.index];
+        return *static_cast<C*>(record.archetype->getComponent(*record.archetype->chunks[record.chunk], record.row, getComponentType<C>().id));
+    }
+
+    // replaces the component if the entity already has one
+    template<typename C>
+    void add(Entity entity, C component) {
+        if(has<C>(entity)) {
+            get<C>(entity) = std::move(component);
+            return;
+        }
+        vector<const ComponentType*> types = entities[entity.index].archetype->types;
+        types.push_back(&getComponentType<C>());
+        moveToArchetype(entity, getArchetype(types));
+        new (&get<C>(entity)) C(std::move(component));
+    }
+
+    template<typename C>
+    void remove(Entity entity) {
+        if(!has<C>(entity)) {
+            return;
+        }
+        vector<const ComponentType*> types = entities[entity.index].archetype->types;
+        erase(types, &getComponentType<C>());
+        moveToArchetype(entity, getArchetype(types));
+    }
+
+    // calls `callback(entities, components...)` with the spans of every chunk holding (at least) components `C`.
+    // components which are only read should be const
+    template<typename... C, typename F>
+    void forEachChunk(F callback) {
+        for(auto [archetype, chunk] : getChunks<C...>()) {
+            visitChunk<C...>(*archetype, *chunk, callback);
+        }
+    }
+
+    // like `forEachChunk`, but chunks are spread over the job system's threads
+    template<typename... C, typename F>
+    void parallelForEachChunk(F callback) {
+        vector<pair<Archetype*, Chunk*>> chunks = getChunks<C...>();
+        getJobSystem().parallelFor(chunks.size(), [&](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; i++) {
+                visitChunk<C...>(*chunks[i].first, *chunks[i].second, callback);
+            }
+        });
+    }
+
+    // calls `callback(components...)` for every entity with (at least) components `C`
+    template<typename... C, typename F>
+    void each(F callback) {
+        forEachChunk<C...>([&](span<const Entity> chunkEntities, span<C>... components) {
+            for(size_t i = 0; i < chunkEntities.size(); i++) {
+                callback(components[i]...);
+            }
+        });
+    }
+
+    size_t size() const;
+};
+
+#endif //GAME_ENGINE_ECS_H
@@ -0,0 +1,98 @@
+#include "GeometryPool.h"
+
+RangeAllocator::RangeAllocator(size_t capacity) : capacity(capacity) {
+    reset();
+}
+
+void RangeAllocator::insertFree(size_t offset, size_t size) {
+    freeByOffset[offset] = size;
+    freeBySize.emplace(size, offset);
+}
+
+void RangeAllocator::eraseFree(map<size_t, size_t>::iterator it) {
+    auto [first, last] = freeBySize.equal_range(it->second);
+    for(auto sizeIt = first; sizeIt != last; sizeIt++) {
+        if(sizeIt->second == it->first) {
+            freeBySize.erase(sizeIt);
+            break;
+        }
+    }
+    freeByOffset.erase(it);
+}
+
+optional<size_t> RangeAllocator::allocate(size_t size, size_t alignment) {
+    assert(size > 0);
+    assert((alignment & (alignment - 1)) == 0);
+
+    // smallest free range which can hold `size` after aligning its start
+    for(auto sizeIt = freeBySize.lower_bound(size); sizeIt != freeBySize.end(); sizeIt++) {
+        size_t rangeOffset = sizeIt->second;
+        size_t rangeSize = sizeIt->first;
+        size_t alignedOffset = (rangeOffset + alignment - 1) & ~(alignment - 1);
+        size_t padding = alignedOffset - rangeOffset;
+        if(padding + size > rangeSize) {
+            continue;
+        }
+
+        eraseFree(freeByOffset.find(rangeOffset));
+        if(padding > 0) {
+            insertFree(rangeOffset, padding);
+        }
+        if(padding + size < rangeSize) {
+            insertFree(alignedOffset + size, rangeSize - padding - size);
+        }
+
+        numAllocated += size;
+        return alignedOffset;
+    }
+
+    return nullopt;
+}
+
+void RangeAllocator::free(size_t offset, size_t size) {
+    assert(offset + size <= capacity);
+    assert(numAllocated >= size);
+    numAllocated -= size;
+
+    // merge with the free ranges directly after and before
+    auto next = freeByOffset.lower_bound(offset);
+    assert(next == freeByOffset.end() || next->first >= offset + size);
+    if(next != freeByOffset.end() && next->first == offset + size) {
+        size += next->second;
+        auto following = std::next(next);
+        eraseFree(next);
+        next = following;
+    }
+    if(next != freeByOffset.begin()) {
+        auto previous = std::prev(next);
+        assert(previous->first + previous->second <= offset);
+        if(previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            eraseFree(previous);
+        }
+    }
+
+    insertFree(offset, size);
+}
+
+void RangeAllocator::reset() {
+    freeByOffset.clear();
+    freeBySize.clear();
+    numAllocated = 0;
+    if(capacity > 0) {
+        insertFree(0, capacity);
+    }
+}
+
+size_t RangeAllocator::getCapacity() const {
+    return capacity;
+}
+
+size_t RangeAllocator::getNumAllocated() const {
+    return numAllocated;
+}
+
+size_t RangeAllocator::getLargestFreeRange() const {
+    return freeBySize.empty() ? 0 : prev(freeBySize.end())->first;
+}
@@ -0,0 +1,183 @@
+#ifndef GAME_ENGINE_GEOMETRYPOOL_H
+#define GAME_ENGINE_GEOMETRYPOOL_H
+
+#include "OpenGLContext.h"
+#include "buffer.h"
+#include "../loader/models.h"
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <functional>
+
+using namespace std;
+
+// hands out ranges of a fixed capacity, e.g.: elements of a buffer.
+// free ranges are indexed by both offset (to coalesce neighbours on `free`)
+// and size (so `allocate` picks the smallest range which fits).
+class RangeAllocator {
+    size_t capacity;
+    size_t numAllocated = 0;
+    map<size_t, size_t> freeByOffset;
+    multimap<size_t, size_t> freeBySize;
+
+    void insertFree(size_t offset, size_t size);
+    void eraseFree(map<size_t, size_t>::iterator it);
+
+public:
+    explicit RangeAllocator(size_t capacity);
+
+    // returns the offset of the new range, `alignment` must be a power of two
+    optional<size_t> allocate(size_t size, size_t alignment = 1);
+    void free(size_t offset, size_t size);
+    // forgets every allocation
+    void reset();
+
+    size_t getCapacity() const;
+    size_t getNumAllocated() const;
+    size_t getLargestFreeRange() const;
+};
+
+// owns one large vertex buffer and one index buffer for meshes with vertex layout `V`,
+// so meshes sharing a pipeline can all be drawn without rebinding buffers.
+// indices of both formats share the index buffer, see `ModelBufferSlices::indexFormat`
+template<typename V>
+class GeometryPool {
+    OpenGLContext& context;
+    unique_ptr<ArrayBuffer<V>> vertexBuffer;
+    unique_ptr<ArrayBuffer<uint8_t>> indexBuffer;
+    RangeAllocator vertexRanges;
+    // counted in bytes, ranges are aligned so either index format fits
+    RangeAllocator indexRanges;
+    // live allocations keyed by their first vertex, needed to defragment
+    map<size_t, ModelBufferSlices> allocations;
+
+    static size_t indexBytes(const ModelBufferSlices& slices) {
+        return slices.indices.numElements * indexFormatGetBytes(slices.indexFormat);
+    }
+
+public:
+    GeometryPool(OpenGLContext& context, size_t maxVertices, size_t maxIndexBytes) :
+            context(context),
+            vertexBuffer(context.buildWritableArrayBuffer<V>(BufferUsage::STATIC_DRAW, maxVertices).onHeap()),
+            indexBuffer(context.buildWritableArrayBuffer<uint8_t>(BufferUsage::STATIC_DRAW, maxIndexBytes).onHeap()),
+            vertexRanges(maxVertices),
+            indexRanges(maxIndexBytes) {}
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    // reserves room for a mesh, without writing anything. returns `nullopt` when the pool is full
+    optional<ModelBufferSlices> allocate(size_t numVertices, size_t numIndices, IndexFormat indexFormat) {
+        assert(numVertices > 0);
+        optional<size_t> vertexOffset = vertexRanges.allocate(numVertices);
+        if(!vertexOffset) {
+            return nullopt;
+        }
+
+        size_t indexSize = indexFormatGetBytes(indexFormat);
+        optional<size_t> indexByteOffset = indexRanges.allocate(max<size_t>(1, numIndices * indexSize), sizeof(uint32_t));
+        if(!indexByteOffset) {
+            vertexRanges.free(*vertexOffset, numVertices);
+            return nullopt;
+        }
+
+        ModelBufferSlices slices {
+            .vertices = Slice { .elementOffset = *vertexOffset, .numElements = numVertices },
+            .indices = Slice { .elementOffset = *indexByteOffset / indexSize, .numElements = numIndices },
+            .indexFormat = indexFormat
+        };
+        allocations[*vertexOffset] = slices;
+        return slices;
+    }
+
+    // allocates room for `model` and writes its vertices and indices into it
+    optional<ModelBufferSlices> upload(Model& model) {
+        optional<ModelBufferSlices> slices = allocate(model.getNumVertices(), model.getNumIndices(), model.getPreferredIndexFormat());
+        if(!slices) {
+            return nullopt;
+        }
+
+        context.withMappedBuffer(getVertices().subslice(slices->vertices), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT,
+                [&model](span<V> vertices) {
+                    model.writeVertices(vertices);
+                });
+
+        size_t indexSize = indexFormatGetBytes(slices->indexFormat);
+        BufferSlice<uint8_t> indexBytes(indexBuffer->unsafeGetInner(), slices->indices.elementOffset * indexSize, slices->indices.numElements * indexSize);
+        context.withMappedBuffer(indexBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT,
+                [&model](span<uint8_t> indices) {
+                    size_t byteOffset = 0;
+                    model.writeIndices(indices, byteOffset);
+                });
+
+        return slices;
+    }
+
+    void free(const ModelBufferSlices& slices) {
+        auto it = allocations.find(slices.vertices.elementOffset);
+        assert(it != allocations.end());
+        allocations.erase(it);
+
+        vertexRanges.free(slices.vertices.elementOffset, slices.vertices.numElements);
+        indexRanges.free(slices.indices.elementOffset * indexFormatGetBytes(slices.indexFormat), max<size_t>(1, indexBytes(slices)));
+    }
+
+    // packs every live mesh to the start of freshly allocated buffers, closing the gaps left by `free`.
+    // the contents are copied on the GPU, and `moved(before, after)` is called for each mesh, so callers
+    // can update the slices they hold. any bindings to the old buffers are invalid afterwards.
+    void defragment(function<void(const ModelBufferSlices& before, const ModelBufferSlices& after)> moved) {
+        auto newVertexBuffer = context.buildWritableArrayBuffer<V>(BufferUsage::STATIC_DRAW, vertexRanges.getCapacity()).onHeap();
+        auto newIndexBuffer = context.buildWritableArrayBuffer<uint8_t>(BufferUsage::STATIC_DRAW, indexRanges.getCapacity()).onHeap();
+
+        vertexRanges.reset();
+        indexRanges.reset();
+        map<size_t, ModelBufferSlices> oldAllocations;
+        oldAllocations.swap(allocations);
+
+        for(auto& [offset, before] : oldAllocations) {
+            ModelBufferSlices after = *allocate(before.vertices.numElements, before.indices.numElements, before.indexFormat);
+            size_t indexSize = indexFormatGetBytes(before.indexFormat);
+
+            context.copyBuffer(vertexBuffer->unsafeGetInner(), before.vertices.elementOffset * sizeof(V),
+                    newVertexBuffer->unsafeGetInner(), after.vertices.elementOffset * sizeof(V),
+                    before.vertices.numElements * sizeof(V));
+            if(before.indices.numElements > 0) {
+                context.copyBuffer(indexBuffer->unsafeGetInner(), before.indices.elementOffset * indexSize,
+                        newIndexBuffer->unsafeGetInner(), after.indices.elementOffset * indexSize,
+                        indexBytes(before));
+            }
+
+            if(before.vertices.elementOffset != after.vertices.elementOffset || before.indices.elementOffset != after.indices.elementOffset) {
+                moved(before, after);
+            }
+        }
+
+        vertexBuffer.reset(newVertexBuffer);
+        indexBuffer.reset(newIndexBuffer);
+    }
+
+    BufferSlice<V> getVertices() {
+        return vertexBuffer->getSlice();
+    }
+
+    const UntypedBuffer& getIndexBuffer() {
+        return indexBuffer->unsafeGetInner();
+    }
+
+    IndexBufferBinding getIndexBinding(const ModelBufferSlices& slices) {
+        return slices.getIndexBinding(getIndexBuffer());
+    }
+
+    size_t getNumAllocatedVertices() const {
+        return vertexRanges.getNumAllocated();
+    }
+
+    // whether a mesh of this size would currently fit, without defragmenting
+    bool canFit(size_t numVertices, size_t numIndices, IndexFormat indexFormat) const {
+        return vertexRanges.getLargestFreeRange() >= numVertices &&
+               indexRanges.getLargestFreeRange() >= numIndices * indexFormatGetBytes(indexFormat) + sizeof(uint32_t);
+    }
+};
+
+#endif //GAME_ENGINE_GEOMETRYPOOL_H
@@ -0,0 +1,159 @@
+#ifndef GAME_ENGINE_INSTANCEBATCHER_H
+#define GAME_ENGINE_INSTANCEBATCHER_H
+
+#include "OpenGLContext.h"
+#include "GeometryPool.h"
+#include "commands.h"
+#include "buffer.h"
+#include "../loader/models.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+using namespace std;
+
+// the instance buffer starts with room for this many instances, and doubles whenever a frame needs more
+const size_t INSTANCE_BATCHER_INITIAL_CAPACITY = 1024;
+
+// index into the materials added since the last `clear`
+using MaterialId = uint32_t;
+
+// draws meshes submitted one at a time, e.g.: per entity, with as few draws as possible. items sharing
+// a mesh and a material become one instanced draw: their instances are written next to each other in one
+// buffer, and each draw starts at its own `firstInstance`. `V` and `R` are a generated pipeline's bindings,
+// whose vertex bindings are a `perVertex` buffer from a `GeometryPool` and a `perInstance` buffer.
+// meant to be cleared and filled again every frame
+template<typename V, typename R>
+class InstanceBatcher {
+    using VertexInput = typename remove_const_t<decltype(V::perVertex)>::Element;
+    using InstanceInput = typename remove_const_t<decltype(V::perInstance)>::Element;
+
+    struct Item {
+        MaterialId material;
+        ModelBufferSlices mesh;
+        glm::mat4 modelMatrix;
+    };
+
+    struct Batch {
+        MaterialId material;
+        ModelBufferSlices mesh;
+        GLuint firstInstance;
+        GLuint instanceCount;
+    };
+
+    OpenGLContext& context;
+    GeometryPool<VertexInput>& geometry;
+    unique_ptr<ArrayBuffer<InstanceInput>> instances;
+    size_t capacity = 0;
+
+    vector<R> materials;
+    vector<Item> items;
+    vector<Batch> batches;
+
+    static bool sameBatch(const Item& a, const Item& b) {
+        // a mesh's first vertex is unique among the pool's live meshes
+        return a.material == b.material && a.mesh.vertices.elementOffset == b.mesh.vertices.elementOffset;
+    }
+
+    void reserve(size_t numInstances) {
+        if(numInstances <= capacity) {
+            return;
+        }
+        capacity = max(max(capacity * 2, numInstances), INSTANCE_BATCHER_INITIAL_CAPACITY);
+        instances.reset(context.buildWritableArrayBuffer<InstanceInput>(BufferUsage::DYNAMIC_DRAW, capacity).onHeap());
+    }
+
+public:
+    InstanceBatcher(OpenGLContext& context, GeometryPool<VertexInput>& geometry) : context(context), geometry(geometry) {
+        reserve(INSTANCE_BATCHER_INITIAL_CAPACITY);
+    }
+
+    InstanceBatcher(const InstanceBatcher&) = delete;
+    InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+
+    // forgets the items and materials of the last frame
+    void clear() {
+        materials.clear();
+        items.clear();
+        batches.clear();
+    }
+
+    MaterialId addMaterial(R bindings) {
+        materials.push_back(bindings);
+        return materials.size() - 1;
+    }
+
+    void add(const ModelBufferSlices& mesh, MaterialId material, const glm::mat4& modelMatrix) {
+        assert(material < materials.size());
+        items.push_back(Item { .material = material, .mesh = mesh, .modelMatrix = modelMatrix });
+    }
+
+    // groups the items into batches and writes every instance, must be called before `draw`
+    void upload() {
+        // by material first, so the draws switch textures as rarely as possible
+        stable_sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+            if(a.material != b.material) {
+                return a.material < b.material;
+            }
+            return a.mesh.vertices.elementOffset < b.mesh.vertices.elementOffset;
+        });
+
+        for(size_t i = 0; i < items.size(); i++) {
+            if(i == 0 || !sameBatch(items[i - 1], items[i])) {
+                batches.push_back(Batch {
+                    .material = items[i].material,
+                    .mesh = items[i].mesh,
+                    .firstInstance = static_cast<GLuint>(i),
+                    .instanceCount = 0
+                });
+            }
+            batches.back().instanceCount++;
+        }
+        if(items.empty()) {
+            return;
+        }
+
+        reserve(items.size());
+        BufferSlice<InstanceInput> written = instances->getSlice().subslice(Slice { .elementOffset = 0, .numElements = items.size() });
+        context.withMappedBuffer(written, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT, [this](span<InstanceInput> instances) {
+            constexpr bool hasNormals = requires(InstanceInput i) { i.normalMatrix; };
+            for(size_t i = 0; i < items.size(); i++) {
+                instances[i].modelMatrix = items[i].modelMatrix;
+                if constexpr(hasNormals) {
+                    instances[i].normalMatrix = glm::inverseTranspose(glm::mat3(items[i].modelMatrix));
+                }
+            }
+        });
+    }
+
+    // one draw per batch
+    void draw(RenderTargetGuard& guard, GraphicsPipeline<V, R>& pipeline) {
+        for(const Batch& batch : batches) {
+            guard.draw(DrawCommand<V, R> {
+                    .pipeline = pipeline,
+                    .vertexBindings = V {
+                            .perVertex = geometry.getVertices(),
+                            .perInstance = instances->getSlice()
+                    },
+                    .resourceBindings = materials[batch.material],
+                    .call = IndexedDrawCall(geometry.getIndexBinding(batch.mesh), batch.mesh.vertices.elementOffset),
+                    .instanceCount = batch.instanceCount,
+                    .firstInstance = batch.firstInstance
+            });
+        }
+    }
+
+    size_t getNumBatches() const {
+        return batches.size();
+    }
+
+    size_t getNumInstances() const {
+        return items.size();
+    }
+};
+
+#endif //GAME_ENGINE_INSTANCEBATCHER_H
@@ -82,7 +82,9 @@ UntypedBuffer OpenGLContext::buildBuffer(BufferUsage usage, GLsizeiptr size, con
     glGenBuffers(1, &id);
     UntypedBuffer buffer(id, usage, size);
 
-    bindArrayBuffer(buffer);
+    // always rebind, the name may have been reused from a deleted buffer which was still cached as bound
+    glBindBuffer(GL_ARRAY_BUFFER, id);
+    boundArrayBuffer = id;
     glBufferStorage(GL_ARRAY_BUFFER, size, data, flags);
 
     return std::move(buffer);
@@ -92,6 +94,75 @@ UntypedBuffer OpenGLContext::buildBuffer(BufferUsage usage, GLsizeiptr size, GLb
     return buildBuffer(usage, size, nullptr, flags);
 }
 
+void OpenGLContext::copyBuffer(const UntypedBuffer &from, size_t fromOffset, const UntypedBuffer &to, size_t toOffset, size_t size) {
+    assert(fromOffset + size <= from.size);
+    assert(toOffset + size <= to.size);
+    glBindBuffer(GL_COPY_READ_BUFFER, from.getId());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, to.getId());
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, fromOffset, toOffset, size);
+}
+
+void* OpenGLContext::mapPersistentBuffer(UntypedBuffer &buffer, GLbitfield accessFlags) {
+    bindArrayBuffer(buffer);
+    return glMapBufferRange(GL_ARRAY_BUFFER, 0, buffer.size, accessFlags);
+}
+
+void OpenGLContext::bindPixelUnpackBuffer(const UntypedBuffer *buffer) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer != nullptr ? buffer->getId() : 0);
+}
+
+void OpenGLContext::readPixelsToBuffer(Framebuffer &framebuffer, UntypedBuffer &buffer, size_t byteOffset) {
+    Dimensions2d size = framebuffer.getSize();
+    assert(byteOffset + size_t(size.width) * size.height * 4 <= buffer.size);
+    bindReadFramebuffer(framebuffer.getId());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.getId());
+    glReadPixels(0, 0, size.width, size.height, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<void*>(byteOffset));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+GLsync OpenGLContext::insertFence() {
+    return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool OpenGLContext::hasFenceSignalled(GLsync fence) {
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void OpenGLContext::deleteFence(GLsync fence) {
+    glDeleteSync(fence);
+}
+
+
+shared_ptr<VertexArray> OpenGLContext::getVertexArray(const VertexLayout &layout) {
+    auto [it, inserted] = vertexArrayCache.try_emplace(layout);
+    if(!inserted) {
+        return it->second;
+    }
+
+    auto vertexArray = make_shared<VertexArray>(VertexArray::build());
+    withBoundVertexArray(*vertexArray, [&layout](auto guard) {
+        for(auto& attribute : layout.attributes) {
+            guard.enableAttribute(attribute.location);
+            guard.setAttributeFormat(attribute.location, attribute.format, attribute.offset);
+            guard.setAttributeBinding(attribute.location, attribute.binding);
+        }
+        for(uint32_t binding : layout.instancedBindings) {
+            guard.setBindingDivisor(binding, 1);
+        }
+    });
+    it->second = vertexArray;
+    return vertexArray;
+}
+
+shared_ptr<Sampler> OpenGLContext::getSampler(const SamplerCreateInfo &info) {
+    auto [it, inserted] = samplerCache.try_emplace(info);
+    if(inserted) {
+        it->second = make_shared<Sampler>(Sampler::build(info));
+    }
+    return it->second;
+}
 
 shared_ptr<Program> OpenGLContext::getProgram(ShaderStages stages) {
     auto it = programCache.find(stages);
@@ -104,8 +175,11 @@ shared_ptr<Program> OpenGLContext::getProgram(ShaderStages stages) {
 
         shared_ptr<Program> program = make_shared<Program>(id);
 
-        program->attachShader(*stages.vertex);
-        program->attachShader(*stages.fragment);
+        for(auto& shader : { stages.vertex, stages.fragment, stages.compute }) {
+            if(shader) {
+                program->attachShader(*shader);
+            }
+        }
 
         cout << "linking and validating program (id = " << id << ")" << endl;
 
@@ -144,6 +218,15 @@ void OpenGLContext::bindUniformBuffer(const UntypedBuffer &buffer, GLuint index,
     }
 }
 
+void OpenGLContext::bindStorageBuffer(const UntypedBuffer &buffer, GLuint index, GLintptr byteOffset, GLsizeiptr size) {
+    // storage buffers are rebound every dispatch, unlike uniform buffers there are few enough of them not to track
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, index, buffer.getId(), byteOffset, size);
+}
+
+void OpenGLContext::memoryBarrier(GLbitfield barriers) {
+    glMemoryBarrier(barriers);
+}
+
 void OpenGLContext::switchProgram(const Program &program) {
     if(currentProgram != program.getId()) {
         glUseProgram(program.getId());
@@ -165,20 +248,48 @@ GLuint getTextureFormat(DataFormat format) {
             return GL_SRGB8;
         case R8G8B8A8_SRGB:
             return GL_SRGB8_ALPHA8;
+        case R8_UNORM:
+            return GL_R8;
+        case R8G8_UNORM:
+            return GL_RG8;
         case D16_UNORM:
             return GL_DEPTH_COMPONENT16;
         case D24_UNORM:
             return GL_DEPTH_COMPONENT24;
         case D32_SFLOAT:
             return GL_DEPTH_COMPONENT32F;
+        case BC1_RGB_UNORM:
+            return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case BC3_RGBA_UNORM:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case BC4_R_UNORM:
+            return GL_COMPRESSED_RED_RGTC1;
+        case BC5_RG_UNORM:
+            return GL_COMPRESSED_RG_RGTC2;
         default:
             assert(false);
             return 0;
     }
 }
 
+bool isCompressedFormat(DataFormat format) {
+    switch(format) {
+        case BC1_RGB_UNORM:
+        case BC3_RGBA_UNORM:
+        case BC4_R_UNORM:
+        case BC5_RG_UNORM:
+            return true;
+        default:
+            return false;
+    }
+}
+
 GLuint getTransferDataFormat(TransferFormat format) {
     switch(format) {
+        case TransferFormat::R8_UINT:
+            return GL_RED;
+        case TransferFormat::R8G8_UINT:
+            return GL_RG;
         case TransferFormat::R8G8B8_UINT:
             return GL_RGB;
         case TransferFormat::R8G8B8A8_UINT:
@@ -191,6 +302,8 @@ GLuint getTransferDataFormat(TransferFormat format) {
 
 GLuint getTransferDataType(TransferFormat format) {
     switch(format) {
+        case TransferFormat::R8_UINT:
+        case TransferFormat::R8G8_UINT:
         case TransferFormat::R8G8B8_UINT:
         case TransferFormat::R8G8B8A8_UINT:
             return GL_UNSIGNED_BYTE;
@@ -219,6 +332,97 @@ void OpenGLContext::uploadBaseImage2D(Texture2d& texture, TransferFormat format,
     }
 }
 
+void OpenGLContext::uploadImage2D(Texture2d &texture, uint32_t level, TransferFormat format, const void *data) {
+    bindTexture(texture);
+    // rows of small RGB, R and RG levels aren't 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(static_cast<GLuint>(texture.type), level, 0, 0, max(1u, texture.size.width >> level), max(1u, texture.size.height >> level),
+                    getTransferDataFormat(format), getTransferDataType(format), data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void OpenGLContext::uploadCompressedImage2D(Texture2d &texture, uint32_t level, const void *data, size_t byteSize) {
+    bindTexture(texture);
+    glCompressedTexSubImage2D(static_cast<GLuint>(texture.type), level, 0, 0, max(1u, texture.size.width >> level), max(1u, texture.size.height >> level),
+                              getTextureFormat(texture.format), byteSize, data);
+}
+
+void OpenGLContext::uploadRegion2D(Texture2d &texture, uint32_t level, Rect2d region, TransferFormat format, const void *data) {
+    bindTexture(texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(static_cast<GLuint>(texture.type), level, region.origin.x, region.origin.y, region.size.width, region.size.height,
+                    getTransferDataFormat(format), getTransferDataType(format), data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+Texture2d OpenGLContext::buildStreamedTexture2D(DataFormat format, Dimensions2d size) {
+    GLuint id;
+    glGenTextures(1, &id);
+    Texture2d tex(id, format, size, true);
+
+    bindTexture(tex);
+    glTexParameteri(static_cast<GLuint>(tex.type), GL_TEXTURE_MAX_LEVEL, floor(log2(max(size.width, size.height))));
+
+    return std::move(tex);
+}
+
+void OpenGLContext::allocateLevel(Texture2d &texture, uint32_t level, TransferFormat format, const void *data) {
+    bindTexture(texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(static_cast<GLuint>(texture.type), level, getTextureFormat(texture.format), max(1u, texture.size.width >> level), max(1u, texture.size.height >> level), 0,
+                 getTransferDataFormat(format), getTransferDataType(format), data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void OpenGLContext::allocateCompressedLevel(Texture2d &texture, uint32_t level, const void *data, size_t byteSize) {
+    bindTexture(texture);
+    glCompressedTexImage2D(static_cast<GLuint>(texture.type), level, getTextureFormat(texture.format), max(1u, texture.size.width >> level), max(1u, texture.size.height >> level), 0,
+                           byteSize, data);
+}
+
+void OpenGLContext::releaseLevel(Texture2d &texture, uint32_t level) {
+    bindTexture(texture);
+    // respecifying the level as empty frees its memory
+    if(isCompressedFormat(texture.format)) {
+        glCompressedTexImage2D(static_cast<GLuint>(texture.type), level, getTextureFormat(texture.format), 0, 0, 0, 0, nullptr);
+    } else {
+        glTexImage2D(static_cast<GLuint>(texture.type), level, getTextureFormat(texture.format), 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+}
+
+void OpenGLContext::setResidentLevels(Texture2d &texture, uint32_t baseLevel) {
+    bindTexture(texture);
+    glTexParameteri(static_cast<GLuint>(texture.type), GL_TEXTURE_BASE_LEVEL, baseLevel);
+    glTexParameterf(static_cast<GLuint>(texture.type), GL_TEXTURE_MIN_LOD, float(baseLevel));
+}
+
+Texture2dArray OpenGLContext::buildTexture2DArray(DataFormat format, Dimensions2d size, uint32_t numLayers, bool hasMipMaps) {
+    GLuint id;
+    glGenTextures(1, &id);
+    Texture2dArray tex(id, format, size, numLayers, hasMipMaps);
+
+    bindTexture(tex);
+    glTexStorage3D(static_cast<GLuint>(tex.type), hasMipMaps ? floor(log2(max(size.width, size.height))) + 1 : 1, getTextureFormat(format), size.width, size.height, numLayers);
+
+    return std::move(tex);
+}
+
+void OpenGLContext::uploadLayer(Texture2dArray &texture, uint32_t layer, uint32_t level, TransferFormat format, const void *data) {
+    assert(layer < texture.numLayers);
+    bindTexture(texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(static_cast<GLuint>(texture.type), level, 0, 0, layer, max(1u, texture.size.width >> level), max(1u, texture.size.height >> level), 1,
+                    getTransferDataFormat(format), getTransferDataType(format), data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void OpenGLContext::uploadCompressedLayer(Texture2dArray &texture, uint32_t layer, uint32_t level, const void *data, size_t byteSize) {
+    assert(layer < texture.numLayers);
+    bindTexture(texture);
+    glCompressedTexSubImage3D(static_cast<GLuint>(texture.type), level, 0, 0, layer, max(1u, texture.size.width >> level), max(1u, texture.size.height >> level), 1,
+                              getTextureFormat(texture.format), byteSize, data);
+}
+
 DefaultRenderTarget &OpenGLContext::getDefaultRenderTarget() {
     return defaultRenderTarget;
 }
@@ -268,7 +472,7 @@ void OpenGLContext::bindReadFramebuffer(GLuint framebufferId) {
     glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferId);
 }
 
-void OpenGLContext::performDrawCall(PrimitiveTopology topology, variant<NonIndexedDrawCall, IndexedDrawCall> drawCall,
+void OpenGLContext::performDrawCall(PrimitiveTopology topology, DrawCall drawCall,
                                     GLuint instanceCount, GLuint firstInstance, BoundVertexArrayGuard guard) {
     GLenum top = static_cast<GLenum>(topology);
     if(auto call = std::get_if<NonIndexedDrawCall>(&drawCall)) {
@@ -301,6 +505,10 @@ void OpenGLContext::performDrawCall(PrimitiveTopology topology, variant<NonIndex
                         instanceCount, call->firstVertex, firstInstance);
             }
         }
+    } else if(auto call = std::get_if<IndirectIndexedDrawCall>(&drawCall)) {
+        guard.bindIndexBuffer(call->indexBuffer.buffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, call->commands.getId());
+        glDrawElementsIndirect(top, static_cast<GLenum>(call->indexBuffer.format), (const void *) call->byteOffset);
     }
 }
 
@@ -415,6 +623,29 @@ void BoundVertexArrayGuard::setAttributeFormat(GLuint location, DataFormat forma
         case R32G32B32A32_SFLOAT:
             glVertexAttribFormat(location, 4, GL_FLOAT, GL_FALSE, offset);
             break;
+        case R16G16_SFLOAT:
+            glVertexAttribFormat(location, 2, GL_HALF_FLOAT, GL_FALSE, offset);
+            break;
+        case R16G16B16A16_SFLOAT:
+            glVertexAttribFormat(location, 4, GL_HALF_FLOAT, GL_FALSE, offset);
+            break;
+        // normalized formats are read by the shader as floats in [-1, 1] or [0, 1]
+        case R16G16_SNORM:
+            glVertexAttribFormat(location, 2, GL_SHORT, GL_TRUE, offset);
+            break;
+        case R16G16B16A16_SNORM:
+            glVertexAttribFormat(location, 4, GL_SHORT, GL_TRUE, offset);
+            break;
+        case R8G8B8A8_UNORM:
+            glVertexAttribFormat(location, 4, GL_UNSIGNED_BYTE, GL_TRUE, offset);
+            break;
+        // integer formats must be declared as `uint`/`uvec*` inputs in the shader
+        case R32_UINT:
+            glVertexAttribIFormat(location, 1, GL_UNSIGNED_INT, offset);
+            break;
+        case R16G16_UINT:
+            glVertexAttribIFormat(location, 2, GL_UNSIGNED_SHORT, offset);
+            break;
         default:
             assert(false);
     }
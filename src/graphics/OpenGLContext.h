@@ -52,7 +52,9 @@ private:
     Window& window;
 
     unordered_map<ShaderStages, shared_ptr<Program>> programCache;
-    GLuint boundArrayBuffer;
+    unordered_map<VertexLayout, shared_ptr<VertexArray>> vertexArrayCache;
+    unordered_map<SamplerCreateInfo, shared_ptr<Sampler>> samplerCache;
+    GLuint boundArrayBuffer = 0;
     GLuint currentVertexArray = 0;
     GLuint currentProgram = 0;
     unordered_map<GLuint, CurrentUniformBufferBinding> boundUniformBuffers;
@@ -66,6 +68,8 @@ private:
     DefaultRenderTarget defaultRenderTarget;
 
     shared_ptr<Program> getProgram(ShaderStages stages);
+    // builds a vertex array the first time a layout is seen, pipelines with the same layout then share it
+    shared_ptr<VertexArray> getVertexArray(const VertexLayout& layout);
 
     void switchProgram(const Program& program);
     void bindArrayBuffer(const UntypedBuffer &buffer);
@@ -101,7 +105,7 @@ private:
         switchDepthStencilState(command.pipeline.depthStencil);
         switchColorBlendState(command.pipeline.colorBlend);
 
-        withBoundVertexArray(command.pipeline.vertexArray, [command, this](auto guard) {
+        withBoundVertexArray(*command.pipeline.vertexArray, [command, this](auto guard) {
             command.pipeline.vertexPipelineState.bindAll(command.vertexBindings, guard, *this);
             command.pipeline.resourcesPipelineState.bindAll(command.resourceBindings, *this);
 
@@ -110,7 +114,7 @@ private:
         });
     }
 
-    void performDrawCall(PrimitiveTopology topology, variant<NonIndexedDrawCall, IndexedDrawCall> call, GLuint instanceCount, GLuint firstInstance, BoundVertexArrayGuard guard);
+    void performDrawCall(PrimitiveTopology topology, DrawCall call, GLuint instanceCount, GLuint firstInstance, BoundVertexArrayGuard guard);
 
     template<typename T>
     void blit(T& from, Rect2d source, Rect2d dest, GLuint bits, SamplerFilter filter) {
@@ -132,12 +136,49 @@ public:
 
     Texture2d buildTexture2D(DataFormat format, Dimensions2d size, bool hasMipMaps);
     void uploadBaseImage2D(Texture2d& texture, TransferFormat transferFormat, const void *data);
+    // uploads a single mip level, which must be tightly packed
+    void uploadImage2D(Texture2d& texture, uint32_t level, TransferFormat transferFormat, const void *data);
+    // for block compressed formats, each mip level has to be uploaded explicitly
+    void uploadCompressedImage2D(Texture2d& texture, uint32_t level, const void *data, size_t byteSize);
+    // uploads part of a mip level, e.g.: one page of a virtual texture's cache
+    void uploadRegion2D(Texture2d& texture, uint32_t level, Rect2d region, TransferFormat transferFormat, const void *data);
+
+    // textures with mutable storage, so single mip levels can be allocated and released while streaming.
+    // only levels between `setResidentLevels`'s `baseLevel` and the last level are ever sampled
+    Texture2d buildStreamedTexture2D(DataFormat format, Dimensions2d size);
+    void allocateLevel(Texture2d& texture, uint32_t level, TransferFormat transferFormat, const void *data);
+    void allocateCompressedLevel(Texture2d& texture, uint32_t level, const void *data, size_t byteSize);
+    void releaseLevel(Texture2d& texture, uint32_t level);
+    void setResidentLevels(Texture2d& texture, uint32_t baseLevel);
+
+    Texture2dArray buildTexture2DArray(DataFormat format, Dimensions2d size, uint32_t numLayers, bool hasMipMaps);
+    // uploads a single mip level of one layer, which must be tightly packed
+    void uploadLayer(Texture2dArray& texture, uint32_t layer, uint32_t level, TransferFormat transferFormat, const void *data);
+    void uploadCompressedLayer(Texture2dArray& texture, uint32_t layer, uint32_t level, const void *data, size_t byteSize);
 
     void setSwapInterval(int nframes);
 
     UntypedBuffer buildBuffer(BufferUsage usage, GLsizeiptr size, const void *data, GLbitfield flags);
     UntypedBuffer buildBuffer(BufferUsage usage, GLsizeiptr size, GLbitfield flags);
 
+    // copies `size` bytes on the GPU, the two ranges mustn't overlap if `from` and `to` are the same buffer
+    void copyBuffer(const UntypedBuffer& from, size_t fromOffset, const UntypedBuffer& to, size_t toOffset, size_t size);
+
+    // `buffer` must have been built with `accessFlags`, which include GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT.
+    // the pointer stays valid (and may be used from any thread) until the buffer is destroyed
+    void* mapPersistentBuffer(UntypedBuffer& buffer, GLbitfield accessFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    // while a buffer is bound, the `data` passed to the texture upload functions is a byte offset into it
+    void bindPixelUnpackBuffer(const UntypedBuffer* buffer);
+    // copies the framebuffer's first color attachment (as RGBA8) into `buffer` at `byteOffset`.
+    // doesn't wait for the GPU, the data can be read once a fence inserted afterwards has been signalled
+    void readPixelsToBuffer(Framebuffer& framebuffer, UntypedBuffer& buffer, size_t byteOffset);
+
+    // signalled once the GPU has finished every command issued before it
+    GLsync insertFence();
+    // doesn't block
+    bool hasFenceSignalled(GLsync fence);
+    void deleteFence(GLsync fence);
+
     template<typename T>
     Buffer<T> buildWritableBuffer(BufferUsage usage) {
         auto buffer = buildBuffer(usage, sizeof(T), GL_MAP_WRITE_BIT);
@@ -158,19 +199,20 @@ public:
 
     Shader buildShader(ShaderType type, std::string description, const std::string_view &source);
 
+    // samplers are immutable, so identical create infos share one sampler object
+    shared_ptr<Sampler> getSampler(const SamplerCreateInfo& info);
+
     template<typename V, typename R, typename S>
     GraphicsPipeline<V, R> buildPipeline(GraphicsPipelineCreateInfo<V, R, S> info) {
         shared_ptr<Program> program = getProgram(info.shaders.getStages());
-        VertexArray vertexArray = VertexArray::build();
-
-        bindVertexArray(vertexArray);
+        shared_ptr<VertexArray> vertexArray = getVertexArray(info.vertexInput.getLayout());
 
-        typename V::PipelineState vertexPipelineState = info.vertexInput.init(vertexArray, *this);
+        typename V::PipelineState vertexPipelineState = info.vertexInput.init();
         typename R::PipelineState resourcePipelineState = info.resourceBindings.init();
 
         return GraphicsPipeline<V, R>(
             program,
-            std::move(vertexArray),
+            vertexArray,
             vertexPipelineState,
             resourcePipelineState,
             info.inputAssembler,
@@ -180,7 +222,25 @@ public:
         );
     }
 
+    template<typename R, typename S>
+    ComputePipeline<R> buildPipeline(ComputePipelineCreateInfo<R, S> info) {
+        return ComputePipeline<R>(getProgram(info.shaders.getStages()), info.resourceBindings.init());
+    }
+
+    // compute work isn't tied to a render target. its writes are only visible to later commands
+    // after a matching `memoryBarrier`
+    template<typename R>
+    void dispatch(DispatchCommand<R> command) {
+        switchProgram(*command.pipeline.program);
+        command.pipeline.resourcesPipelineState.bindAll(command.resourceBindings, *this);
+        glDispatchCompute(command.groupsX, command.groupsY, command.groupsZ);
+    }
+
+    // `barriers` are GL_*_BARRIER_BIT, naming how the data written by earlier shaders will be read next
+    void memoryBarrier(GLbitfield barriers);
+
     void bindUniformBuffer(const UntypedBuffer &buffer, GLuint index, GLintptr byteOffset, GLsizeiptr size);
+    void bindStorageBuffer(const UntypedBuffer &buffer, GLuint index, GLintptr byteOffset, GLsizeiptr size);
 
     template<typename T>
     void bindTextureAndSampler(uint32_t unit, const TextureBinding<T>& binding) {
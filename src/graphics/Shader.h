@@ -13,7 +13,8 @@ class OpenGLContext;
 
 enum ShaderType {
     VERTEX = GL_VERTEX_SHADER,
-    FRAGMENT = GL_FRAGMENT_SHADER
+    FRAGMENT = GL_FRAGMENT_SHADER,
+    COMPUTE = GL_COMPUTE_SHADER
 };
 
 /**
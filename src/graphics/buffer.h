@@ -15,7 +15,10 @@ using namespace std;
 enum BufferUsage {
     STATIC_DRAW  = GL_STATIC_DRAW,
     DYNAMIC_DRAW = GL_DYNAMIC_DRAW,
-    STREAM_DRAW = GL_STREAM_DRAW
+    STREAM_DRAW = GL_STREAM_DRAW,
+    STREAM_READ = GL_STREAM_READ,
+    // written by the GPU itself, e.g. from a compute shader
+    DYNAMIC_COPY = GL_DYNAMIC_COPY
 };
 
 enum DataFormat {
@@ -27,9 +30,23 @@ enum DataFormat {
     R32G32_SFLOAT,
     R32G32B32_SFLOAT,
     R32G32B32A32_SFLOAT,
+    R16G16_SFLOAT,
+    R16G16B16A16_SFLOAT,
+    R16G16_SNORM,
+    R16G16B16A16_SNORM,
+    R8G8B8A8_UNORM,
+    R8_UNORM,
+    R8G8_UNORM,
+    R32_UINT,
+    R16G16_UINT,
     D16_UNORM,
     D24_UNORM,
-    D32_SFLOAT
+    D32_SFLOAT,
+    // block compressed, textures only
+    BC1_RGB_UNORM,
+    BC3_RGBA_UNORM,
+    BC4_R_UNORM,
+    BC5_RG_UNORM
 };
 
 class UntypedBuffer : public OpenGLResource<UntypedBuffer> {
@@ -172,6 +189,8 @@ struct UntypedBufferBinding {
 
 template<typename T>
 struct VertexBufferBinding {
+    using Element = T;
+
     const UntypedBuffer& buffer;
     const size_t byteOffset;
 
@@ -199,6 +218,11 @@ struct IndexBufferBinding {
 
     IndexBufferBinding(BufferSlice<uint32_t> slice) : buffer(slice.buffer), format(IndexFormat::UINT32), indexCount(slice.numElements), byteOffset(slice.byteOffset) {}
     IndexBufferBinding(BufferSlice<uint16_t> slice) : buffer(slice.buffer), format(IndexFormat::UINT16), indexCount(slice.numElements), byteOffset(slice.byteOffset) {}
+    // for buffers which pack indices of both formats together
+    IndexBufferBinding(const UntypedBuffer& buffer, IndexFormat format, size_t indexCount, size_t byteOffset) : buffer(buffer), format(format), indexCount(indexCount), byteOffset(byteOffset) {
+        assert(byteOffset % indexFormatGetBytes(format) == 0);
+        assert(byteOffset + indexCount * indexFormatGetBytes(format) <= buffer.size);
+    }
 };
 
 
@@ -41,6 +41,28 @@ struct IndexedDrawCall {
             : indexBuffer(indexBuffer), firstVertex(firstVertex) {}
 };
 
+// the layout `glDrawElementsIndirect` reads, e.g.: filled in by a culling compute shader
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// the counts come from a `DrawElementsIndirectCommand` in a buffer, so the `DrawCommand`'s instance count is ignored.
+// only the index format is taken from the index buffer binding
+struct IndirectIndexedDrawCall {
+    const IndexBufferBinding indexBuffer;
+    const UntypedBuffer& commands;
+    const size_t byteOffset = 0;
+
+    IndirectIndexedDrawCall(IndexBufferBinding indexBuffer, const UntypedBuffer& commands, size_t byteOffset)
+            : indexBuffer(indexBuffer), commands(commands), byteOffset(byteOffset) {}
+};
+
+using DrawCall = variant<NonIndexedDrawCall, IndexedDrawCall, IndirectIndexedDrawCall>;
+
 template<typename V, typename R>
 struct DrawCommand {
     GraphicsPipeline<V, R>& pipeline;
@@ -48,7 +70,7 @@ struct DrawCommand {
     const V vertexBindings;
     const R resourceBindings;
 
-    const variant<NonIndexedDrawCall, IndexedDrawCall> call;
+    const DrawCall call;
 
     const GLuint instanceCount = 1;
     const GLuint firstInstance = 0;
@@ -56,4 +78,16 @@ struct DrawCommand {
 
 using UntypedDrawCommand = DrawCommand<UntypedVertexBindings, UntypedResourceBindings>;
 
+template<typename R>
+struct DispatchCommand {
+    ComputePipeline<R>& pipeline;
+
+    const R resourceBindings;
+
+    // work groups, not invocations
+    const GLuint groupsX;
+    const GLuint groupsY = 1;
+    const GLuint groupsZ = 1;
+};
+
 #endif //GAME_ENGINE_COMMANDS_H
@@ -3,6 +3,8 @@
 
 #include "OpenGLContext.h"
 
+#include <algorithm>
+
 UntypedVertexBindings::UntypedVertexBindings(unordered_map<uint32_t, UntypedVertexBufferBinding> bindings) : bindings(bindings) { }
 
 void UntypedVertexBindingPipelineState::bindAll(const UntypedVertexBindings &bindings, BoundVertexArrayGuard& guard, OpenGLContext& context) {
@@ -25,24 +27,20 @@ void UntypedResourceBindingPipelineState::bindAll(const UntypedResourceBindings
     }
 }
 
-UntypedVertexBindingPipelineState UntypedVertexInputCreateInfo::init(VertexArray& array, OpenGLContext& context) {
-    context.withBoundVertexArray(array, [this](auto guard) {
-        for(auto& attribute : attributes) {
-            guard.enableAttribute(attribute.location);
-            guard.setAttributeFormat(attribute.location, attribute.format, attribute.offset);
-            guard.setAttributeBinding(attribute.location, attribute.binding);
-        };
-
-        for(auto& binding : bindings) {
-            if(binding.inputRate == InputRate::PER_INSTANCE) {
-                guard.setBindingDivisor(binding.binding, 1);
-            }
+VertexLayout UntypedVertexInputCreateInfo::getLayout() const {
+    VertexLayout layout { .attributes = attributes };
+    for(auto& binding : bindings) {
+        if(binding.inputRate == InputRate::PER_INSTANCE) {
+            layout.instancedBindings.push_back(binding.binding);
         }
-    });
+    }
+    sort(layout.attributes.begin(), layout.attributes.end(), [](auto& a, auto& b) { return a.location < b.location; });
+    sort(layout.instancedBindings.begin(), layout.instancedBindings.end());
+    return layout;
+}
 
-    return UntypedVertexBindingPipelineState {
-        .layout = bindings
-    };
+UntypedVertexBindingPipelineState UntypedVertexInputCreateInfo::init() {
+    return UntypedVertexBindingPipelineState(bindings);
 }
 
 UntypedResourceBindingPipelineState UntypedResourceBindingCreateInfo::init() {
@@ -46,6 +46,19 @@ struct VertexInputAttribute {
     uint32_t binding;
     DataFormat format;
     uint32_t offset;
+
+    bool operator==(const VertexInputAttribute& other) const = default;
+};
+
+// everything a vertex array object stores about its attributes (strides are passed along with each buffer instead).
+// pipelines with equal layouts share one vertex array, see `OpenGLContext::getVertexArray`
+struct VertexLayout {
+    // sorted by location
+    vector<VertexInputAttribute> attributes;
+    // sorted, every other binding advances per vertex
+    vector<uint32_t> instancedBindings;
+
+    bool operator==(const VertexLayout& other) const = default;
 };
 
 struct InputAssemblerState {
@@ -168,11 +181,14 @@ struct ColorBlendState {
 struct ShaderStages {
     shared_ptr<Shader> vertex;
     shared_ptr<Shader> fragment;
+    // compute pipelines only have this one
+    shared_ptr<Shader> compute;
     // TODO: optional other stages
 
     bool operator==(const ShaderStages &other) const {
         return (vertex == other.vertex
-                && fragment == other.fragment);
+                && fragment == other.fragment
+                && compute == other.compute);
     }
 
     ShaderStages getStages() const {
@@ -192,7 +208,25 @@ struct hash<ShaderStages> {
 
         // should maybe use boost::hash_combine instead
         return ((hash<shared_ptr<Shader>>()(k.vertex)
-                 ^ (hash<shared_ptr<Shader>>()(k.fragment) << 1)) >> 1);
+                 ^ (hash<shared_ptr<Shader>>()(k.fragment) << 1)) >> 1)
+                 ^ (hash<shared_ptr<Shader>>()(k.compute) << 2);
+    }
+};
+
+template<>
+struct hash<VertexLayout> {
+    std::size_t operator()(const VertexLayout &k) const {
+        size_t h = 0;
+        for(auto& attribute : k.attributes) {
+            h = h * 31 + attribute.location;
+            h = h * 31 + attribute.binding;
+            h = h * 31 + attribute.format;
+            h = h * 31 + attribute.offset;
+        }
+        for(uint32_t binding : k.instancedBindings) {
+            h = h * 31 + binding;
+        }
+        return h;
     }
 };
 
@@ -217,7 +251,8 @@ struct UntypedVertexInputCreateInfo {
     vector<VertexInputBinding> bindings;
     vector<VertexInputAttribute> attributes;
 
-    UntypedVertexBindingPipelineState init(VertexArray& array, OpenGLContext& context);
+    VertexLayout getLayout() const;
+    UntypedVertexBindingPipelineState init();
 };
 
 struct UntypedResourceBindingCreateInfo {
@@ -258,7 +293,8 @@ template<typename V, typename R>
 class GraphicsPipeline {
 public:
     shared_ptr<Program> program;
-    VertexArray vertexArray;
+    // may be shared with other pipelines
+    shared_ptr<VertexArray> vertexArray;
     V::PipelineState vertexPipelineState;
     R::PipelineState resourcesPipelineState;
     InputAssemblerState inputAssembler;
@@ -276,10 +312,10 @@ public:
     // DynamicState;
 
 public:
-    GraphicsPipeline(shared_ptr<Program> program, VertexArray &&vertexArray,
+    GraphicsPipeline(shared_ptr<Program> program, shared_ptr<VertexArray> vertexArray,
                      V::PipelineState vertexPipelineState, R::PipelineState resourcesPipelineState, InputAssemblerState inputAssembler,
                      RasterizerState rasterizer, DepthStencilState depthStencil, ColorBlendState colorBlend)
-            : program(program), vertexArray(std::move(vertexArray)), vertexPipelineState(vertexPipelineState), resourcesPipelineState(resourcesPipelineState),
+            : program(program), vertexArray(vertexArray), vertexPipelineState(vertexPipelineState), resourcesPipelineState(resourcesPipelineState),
               inputAssembler(inputAssembler), rasterizer(rasterizer), depthStencil(depthStencil),
               colorBlend(colorBlend) {
 
@@ -292,4 +328,26 @@ public:
 
 using UntypedGraphicsPipeline = GraphicsPipeline<UntypedVertexBindings, UntypedResourceBindings>;
 
+template<typename R, typename S>
+struct ComputePipelineCreateInfo {
+    S shaders;
+    R::CreateInfo resourceBindings {};
+};
+
+template<typename R>
+class ComputePipeline {
+public:
+    shared_ptr<Program> program;
+    R::PipelineState resourcesPipelineState;
+
+    ComputePipeline(shared_ptr<Program> program, R::PipelineState resourcesPipelineState)
+            : program(program), resourcesPipelineState(resourcesPipelineState) {
+
+    }
+
+    ComputePipeline<R>* onHeap() {
+        return new ComputePipeline<R>(std::move(*this));
+    }
+};
+
 #endif //GAME_ENGINE_PIPELINE_H
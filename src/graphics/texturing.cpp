@@ -1,6 +1,8 @@
 
 #include "texturing.h"
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 
 Texture::Texture(GLuint id, TextureType type, DataFormat format, Dimensions2d size, bool hasMipMaps) : OpenGLResource(id), type(type), format(format), size(size), hasMipMaps(hasMipMaps) {}
 
@@ -8,6 +10,43 @@ void Texture::destroyResource() {
     glDeleteTextures(1, &id);
 }
 
+static size_t getLevelByteSize(DataFormat format, uint32_t width, uint32_t height) {
+    size_t blocks = size_t((width + 3) / 4) * ((height + 3) / 4);
+    size_t texels = size_t(width) * height;
+    switch(format) {
+        case BC1_RGB_UNORM:
+        case BC4_R_UNORM:
+            return blocks * 8;
+        case BC3_RGBA_UNORM:
+        case BC5_RG_UNORM:
+            return blocks * 16;
+        case R8_UNORM:
+            return texels;
+        case R8G8_UNORM:
+        case D16_UNORM:
+            return texels * 2;
+        case R32G32_SFLOAT:
+        case R16G16B16A16_SFLOAT:
+        case R16G16B16A16_SNORM:
+            return texels * 8;
+        case R32G32B32_SFLOAT:
+        case R32G32B32A32_SFLOAT:
+            return texels * 16;
+        default:
+            // RGB8 is padded to 4 bytes per texel, D24 to 32 bits
+            return texels * 4;
+    }
+}
+
+size_t Texture::getByteSize() const {
+    uint32_t numLevels = hasMipMaps ? floor(log2(max(size.width, size.height))) + 1 : 1;
+    size_t bytes = 0;
+    for(uint32_t level = 0; level < numLevels; level++) {
+        bytes += getLevelByteSize(format, max(1u, size.width >> level), max(1u, size.height >> level));
+    }
+    return bytes;
+}
+
 GLuint getMinFilterEnum(SamplerFilter minFilter, SamplerMipmapMode mipmapMode) {
     if(minFilter == SamplerFilter::NEAREST) {
         if(mipmapMode == SamplerMipmapMode::NEAREST) {
@@ -67,6 +106,14 @@ Texture2d::Texture2d(GLuint id, DataFormat format, Dimensions2d size, bool hasMi
 
 }
 
+Texture2dArray::Texture2dArray(GLuint id, DataFormat format, Dimensions2d size, uint32_t numLayers, bool hasMipMaps) : Texture(id, TextureType::TEXTURE_2D_ARRAY, format, size, hasMipMaps), numLayers(numLayers) {
+
+}
+
+size_t Texture2dArray::getByteSize() const {
+    return Texture::getByteSize() * numLayers;
+}
+
 SamplerCreateInfo SamplerCreateInfo::ALL_NEAREST = SamplerCreateInfo(SamplerFilter::NEAREST, SamplerMipmapMode::NEAREST);
 SamplerCreateInfo SamplerCreateInfo::ALL_LINEAR = SamplerCreateInfo(SamplerFilter::LINEAR, SamplerMipmapMode::LINEAR);
 
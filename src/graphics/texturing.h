@@ -11,10 +11,13 @@ enum class TextureType {
     TEXTURE_1D = GL_TEXTURE_1D,
     TEXTURE_2D = GL_TEXTURE_2D,
     TEXTURE_3D = GL_TEXTURE_3D,
+    TEXTURE_2D_ARRAY = GL_TEXTURE_2D_ARRAY,
     CUBE_MAP = GL_TEXTURE_CUBE_MAP
 };
 
 enum class TransferFormat {
+    R8_UINT,
+    R8G8_UINT,
     R8G8B8_UINT,
     R8G8B8A8_UINT
 };
@@ -55,8 +58,28 @@ struct SamplerCreateInfo {
     SamplerCreateInfo withAddressMode(SamplerAddressMode mode);
     SamplerCreateInfo withCubeMapSeamless(bool seamless);
     SamplerCreateInfo withAnisotropicFiltering(float amount);
+
+    bool operator==(const SamplerCreateInfo& other) const = default;
+};
+
+namespace std {
+
+template<>
+struct hash<SamplerCreateInfo> {
+    std::size_t operator()(const SamplerCreateInfo &k) const {
+        size_t h = static_cast<size_t>(k.magFilter);
+        h = h * 31 + static_cast<size_t>(k.minFilter);
+        h = h * 31 + static_cast<size_t>(k.mipmapMode);
+        h = h * 31 + static_cast<size_t>(k.addressModeU);
+        h = h * 31 + static_cast<size_t>(k.addressModeV);
+        h = h * 31 + static_cast<size_t>(k.addressModeW);
+        h = h * 31 + k.cubemapSeamless;
+        return h ^ (hash<optional<float>>()(k.anisotropicFiltering) << 1);
+    }
 };
 
+}
+
 class Sampler : public OpenGLResource<Sampler> {
 public:
     Sampler(GLuint id);
@@ -88,6 +111,9 @@ public:
     const DataFormat format;
     const Dimensions2d size;
 
+    // roughly how much video memory one layer of the texture takes up, including mip levels
+    size_t getByteSize() const;
+
     void destroyResource();
 
 };
@@ -101,4 +127,18 @@ public:
     }
 };
 
+// a stack of same sized, same format 2D textures, sampled as `sampler2DArray`
+class Texture2dArray : public Texture {
+public:
+    Texture2dArray(GLuint id, DataFormat format, Dimensions2d size, uint32_t numLayers, bool hasMipMaps);
+
+    const uint32_t numLayers;
+
+    size_t getByteSize() const;
+
+    TextureBinding<Texture2dArray> withSampler(const Sampler& sampler) {
+        return { .texture = *this, .sampler = sampler };
+    }
+};
+
 #endif //GAME_ENGINE_TEXTURING_H
@@ -0,0 +1,336 @@
+#include "jobs.h"
+
+#include <cassert>
+
+struct Job {
+    function<void()> work;
+    JobAffinity affinity;
+    // handles, a queue holding the job and the jobs which precede it each hold one
+    atomic<uint32_t> references;
+    // unfinished jobs preceding this one, plus one until its graph is submitted
+    atomic<uint32_t> pendingDependencies;
+    atomic<bool> done = false;
+    // only changed before the job is submitted, each holds a reference
+    vector<Job*> successors;
+
+    Job(function<void()> work, JobAffinity affinity, uint32_t references, uint32_t pendingDependencies)
+        : work(std::move(work)), affinity(affinity), references(references), pendingDependencies(pendingDependencies) {}
+    ~Job();
+};
+
+static void acquire(Job* job) {
+    job->references.fetch_add(1, memory_order_relaxed);
+}
+
+static void release(Job* job) {
+    if(job->references.fetch_sub(1, memory_order_acq_rel) == 1) {
+        delete job;
+    }
+}
+
+Job::~Job() {
+    // only left over if the job never ran, e.g.: its graph was cleared without being submitted
+    for(Job* successor : successors) {
+        release(successor);
+    }
+}
+
+// fixed size Chase-Lev deque, with the memory orderings from "Correct and Efficient Work-Stealing for Weak
+// Memory Models" (Lê et al.). only the owning thread pushes and pops at the bottom, any thread steals from the top
+class WorkStealingDeque {
+    static_assert((JOB_DEQUE_CAPACITY & (JOB_DEQUE_CAPACITY - 1)) == 0);
+
+    atomic<int64_t> top = 0;
+    atomic<int64_t> bottom = 0;
+    atomic<Job*> jobs[JOB_DEQUE_CAPACITY];
+
+public:
+    // false if the deque is full
+    bool push(Job* job) {
+        int64_t b = bottom.load(memory_order_relaxed);
+        int64_t t = top.load(memory_order_acquire);
+        if(b - t >= static_cast<int64_t>(JOB_DEQUE_CAPACITY)) {
+            return false;
+        }
+        jobs[b & (JOB_DEQUE_CAPACITY - 1)].store(job, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        bottom.store(b + 1, memory_order_relaxed);
+        return true;
+    }
+
+    Job* pop() {
+        int64_t b = bottom.load(memory_order_relaxed) - 1;
+        bottom.store(b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t t = top.load(memory_order_relaxed);
+        if(t > b) {
+            bottom.store(b + 1, memory_order_relaxed);
+            return nullptr;
+        }
+        Job* job = jobs[b & (JOB_DEQUE_CAPACITY - 1)].load(memory_order_relaxed);
+        if(t == b) {
+            // the last job, which a thief may be taking at the same time
+            if(!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+                job = nullptr;
+            }
+            bottom.store(b + 1, memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* steal() {
+        int64_t t = top.load(memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t b = bottom.load(memory_order_acquire);
+        if(t >= b) {
+            return nullptr;
+        }
+        Job* job = jobs[t & (JOB_DEQUE_CAPACITY - 1)].load(memory_order_relaxed);
+        if(!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+};
+
+// the job system the current thread belongs to, if any, and the index of its deque
+static thread_local JobSystem* currentSystem = nullptr;
+static thread_local size_t currentDeque = 0;
+
+JobHandle::JobHandle(Job *job) : job(job) {}
+
+JobHandle::JobHandle(const JobHandle &other) : job(other.job) {
+    if(job != nullptr) {
+        acquire(job);
+    }
+}
+
+JobHandle::JobHandle(JobHandle &&other) noexcept : job(other.job) {
+    other.job = nullptr;
+}
+
+JobHandle &JobHandle::operator=(JobHandle other) {
+    swap(job, other.job);
+    return *this;
+}
+
+JobHandle::~JobHandle() {
+    if(job != nullptr) {
+        release(job);
+    }
+}
+
+bool JobHandle::isValid() const {
+    return job != nullptr;
+}
+
+bool JobHandle::isDone() const {
+    return job->done.load(memory_order_acquire);
+}
+
+JobSystem::JobSystem(size_t numWorkers) : contextThread(this_thread::get_id()) {
+    for(size_t i = 0; i <= numWorkers; i++) {
+        deques.push_back(make_unique<WorkStealingDeque>());
+    }
+    currentSystem = this;
+    currentDeque = numWorkers;
+    for(size_t i = 0; i < numWorkers; i++) {
+        workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    stopping = true;
+    {
+        lock_guard lock(sleepMutex);
+    }
+    workAvailable.notify_all();
+    workers.clear();
+    if(currentSystem == this) {
+        currentSystem = nullptr;
+    }
+}
+
+void JobSystem::workerLoop(size_t index) {
+    currentSystem = this;
+    currentDeque = index;
+    while(!stopping) {
+        if(Job* job = findJob()) {
+            execute(job);
+            continue;
+        }
+        unique_lock lock(sleepMutex);
+        sleepingWorkers++;
+        workAvailable.wait(lock, [this]() { return stopping || queuedJobs > 0; });
+        sleepingWorkers--;
+    }
+}
+
+void JobSystem::schedule(Job *job) {
+    if(job->affinity == JobAffinity::CONTEXT_THREAD) {
+        lock_guard lock(contextMutex);
+        contextJobs.push_back(job);
+        return;
+    }
+
+    // counted first, so a thief can't take the job before it has been counted
+    queuedJobs++;
+    if(currentSystem == this) {
+        if(!deques[currentDeque]->push(job)) {
+            queuedJobs--;
+            execute(job);
+            return;
+        }
+    } else {
+        lock_guard lock(injectedMutex);
+        injected.push_back(job);
+    }
+    // taking the lock means a worker about to sleep either sees the job or is woken up
+    if(sleepingWorkers > 0) {
+        {
+            lock_guard lock(sleepMutex);
+        }
+        workAvailable.notify_one();
+    }
+}
+
+void JobSystem::execute(Job *job) {
+    job->work();
+    job->work = nullptr;
+    job->done.store(true, memory_order_release);
+    for(Job* successor : job->successors) {
+        // the last dependency to finish hands its reference to the queue
+        if(successor->pendingDependencies.fetch_sub(1, memory_order_acq_rel) == 1) {
+            schedule(successor);
+        } else {
+            release(successor);
+        }
+    }
+    job->successors.clear();
+    release(job);
+}
+
+Job *JobSystem::findJob() {
+    Job* job = nullptr;
+    if(currentSystem == this) {
+        job = deques[currentDeque]->pop();
+    }
+    if(job == nullptr) {
+        lock_guard lock(injectedMutex);
+        if(!injected.empty()) {
+            job = injected.front();
+            injected.pop_front();
+        }
+    }
+    // starting from the next deque along spreads the thieves out
+    for(size_t i = 1; job == nullptr && i <= deques.size(); i++) {
+        size_t victim = (currentDeque + i) % deques.size();
+        if(currentSystem != this || victim != currentDeque) {
+            job = deques[victim]->steal();
+        }
+    }
+    if(job != nullptr) {
+        queuedJobs--;
+    }
+    return job;
+}
+
+bool JobSystem::runOne() {
+    if(this_thread::get_id() == contextThread) {
+        Job* job = nullptr;
+        {
+            lock_guard lock(contextMutex);
+            if(!contextJobs.empty()) {
+                job = contextJobs.front();
+                contextJobs.pop_front();
+            }
+        }
+        if(job != nullptr) {
+            execute(job);
+            return true;
+        }
+    }
+    if(Job* job = findJob()) {
+        execute(job);
+        return true;
+    }
+    return false;
+}
+
+JobHandle JobSystem::run(function<void()> work, JobAffinity affinity) {
+    // one reference for the handle, one for the queue
+    Job* job = new Job(std::move(work), affinity, 2, 0);
+    schedule(job);
+    return JobHandle(job);
+}
+
+void JobSystem::wait(const JobHandle &job) {
+    assert(job.isValid());
+    while(!job.isDone()) {
+        if(!runOne()) {
+            this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::runContextJobs() {
+    assert(this_thread::get_id() == contextThread);
+    deque<Job*> pending;
+    {
+        lock_guard lock(contextMutex);
+        pending.swap(contextJobs);
+    }
+    for(Job* job : pending) {
+        execute(job);
+    }
+}
+
+size_t JobSystem::getNumThreads() const {
+    return deques.size();
+}
+
+Task TaskGraph::add(function<void()> work, JobAffinity affinity) {
+    assert(!submitted);
+    tasks.push_back(JobHandle(new Job(std::move(work), affinity, 1, 1)));
+    return tasks.size() - 1;
+}
+
+void TaskGraph::precede(Task before, Task after) {
+    assert(!submitted);
+    Job* successor = tasks[after].job;
+    acquire(successor);
+    successor->pendingDependencies.fetch_add(1, memory_order_relaxed);
+    tasks[before].job->successors.push_back(successor);
+}
+
+void TaskGraph::submit(JobSystem &jobs) {
+    assert(!submitted);
+    submitted = true;
+    for(auto& task : tasks) {
+        // otherwise the last task it depends on schedules it
+        if(task.job->pendingDependencies.fetch_sub(1, memory_order_acq_rel) == 1) {
+            acquire(task.job);
+            jobs.schedule(task.job);
+        }
+    }
+}
+
+void TaskGraph::wait(JobSystem &jobs) {
+    for(auto& task : tasks) {
+        jobs.wait(task);
+    }
+}
+
+void TaskGraph::clear() {
+    tasks.clear();
+    submitted = false;
+}
+
+const JobHandle &TaskGraph::getHandle(Task task) const {
+    return tasks[task];
+}
+
+JobSystem &getJobSystem() {
+    static JobSystem jobs;
+    return jobs;
+}
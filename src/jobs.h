@@ -0,0 +1,163 @@
+#ifndef GAME_ENGINE_JOBS_H
+#define GAME_ENGINE_JOBS_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// jobs each thread's deque can hold. pushing onto a full one runs the job straight away instead
+const size_t JOB_DEQUE_CAPACITY = 4096;
+// `parallelFor` aims for this many ranges per thread, so threads which finish early can steal what's left
+const size_t JOB_RANGES_PER_THREAD = 4;
+
+enum class JobAffinity {
+    ANY,
+    // GL calls. only run by the context thread, from `runContextJobs` or while it waits for another job
+    CONTEXT_THREAD
+};
+
+struct Job;
+class WorkStealingDeque;
+
+// a reference to a job, which keeps it alive. cheap to copy
+class JobHandle {
+    Job* job = nullptr;
+
+    // takes over a reference the caller already holds
+    explicit JobHandle(Job* job);
+
+    friend class JobSystem;
+    friend class TaskGraph;
+
+public:
+    JobHandle() = default;
+    JobHandle(const JobHandle& other);
+    JobHandle(JobHandle&& other) noexcept;
+    JobHandle& operator=(JobHandle other);
+    ~JobHandle();
+
+    bool isValid() const;
+    // whether the job has finished running. false for task graph jobs which haven't been submitted
+    bool isDone() const;
+};
+
+// runs jobs on one worker thread per core, plus the context thread (the one which created the job system)
+// whenever it waits. every thread pushes the jobs it spawns onto its own Chase-Lev deque and pops them
+// from the same end, idle threads steal from the other end of someone else's. threads which aren't part
+// of the job system, e.g. the asset loader's, hand their jobs over through a shared queue.
+class JobSystem {
+    thread::id contextThread;
+    // one per worker, the context thread's is last
+    vector<unique_ptr<WorkStealingDeque>> deques;
+
+    mutex injectedMutex;
+    deque<Job*> injected;
+
+    mutex contextMutex;
+    deque<Job*> contextJobs;
+
+    // jobs in the deques and `injected`, idle workers sleep while there are none
+    atomic<size_t> queuedJobs = 0;
+    atomic<size_t> sleepingWorkers = 0;
+    atomic<bool> stopping = false;
+    mutex sleepMutex;
+    condition_variable workAvailable;
+
+    // declared last, so the workers are joined before the queues are destroyed
+    vector<jthread> workers;
+
+    void workerLoop(size_t index);
+    void schedule(Job* job);
+    void execute(Job* job);
+    Job* findJob();
+    // runs one job if there is any this thread may run, returns whether it did
+    bool runOne();
+
+    friend class TaskGraph;
+
+public:
+    explicit JobSystem(size_t numWorkers = max(2u, thread::hardware_concurrency()) - 1);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    JobHandle run(function<void()> work, JobAffinity affinity = JobAffinity::ANY);
+
+    // runs other jobs until `job` is done, so waiting from inside a job can't deadlock
+    void wait(const JobHandle& job);
+
+    // must be called on the context thread, e.g.: once per frame
+    void runContextJobs();
+
+    // workers and the context thread
+    size_t getNumThreads() const;
+
+    // splits [0, count) into contiguous ranges and calls `callback(begin, end)` for each of them, the calling
+    // thread takes the first one. ranges are sized for a few per thread but never smaller than `minGrain`,
+    // so small inputs just run inline. returns once every range has been processed
+    template<typename F>
+    void parallelFor(size_t count, size_t minGrain, F callback) {
+        size_t targetRanges = getNumThreads() * JOB_RANGES_PER_THREAD;
+        size_t grain = max(max<size_t>(1, minGrain), (count + targetRanges - 1) / targetRanges);
+        if(count <= grain) {
+            callback(size_t(0), count);
+            return;
+        }
+
+        vector<JobHandle> ranges;
+        ranges.reserve((count - 1) / grain);
+        for(size_t begin = grain; begin < count; begin += grain) {
+            size_t end = min(begin + grain, count);
+            ranges.push_back(run([&callback, begin, end]() { callback(begin, end); }));
+        }
+        callback(size_t(0), grain);
+        for(auto& range : ranges) {
+            wait(range);
+        }
+    }
+
+    template<typename F>
+    void parallelFor(size_t count, F callback) {
+        parallelFor(count, 1, callback);
+    }
+};
+
+using Task = size_t;
+
+// jobs with dependencies between them, built up front then submitted together. meant to be cleared and
+// rebuilt every frame, jobs of a submitted graph stay alive until they've run even if it's cleared first
+class TaskGraph {
+    vector<JobHandle> tasks;
+    bool submitted = false;
+
+public:
+    TaskGraph() = default;
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    Task add(function<void()> work, JobAffinity affinity = JobAffinity::ANY);
+    // `after` only starts once `before` has finished. not allowed after `submit`
+    void precede(Task before, Task after);
+
+    // starts every task without unfinished dependencies, the rest start as their dependencies finish
+    void submit(JobSystem& jobs);
+    void wait(JobSystem& jobs);
+    // forgets every task, so the graph can be built again
+    void clear();
+
+    const JobHandle& getHandle(Task task) const;
+};
+
+// the one the engine's parallel loops run on. the first thread to call this becomes its context thread
+JobSystem& getJobSystem();
+
+#endif //GAME_ENGINE_JOBS_H
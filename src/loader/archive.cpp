@@ -0,0 +1,164 @@
+#include "archive.h"
+
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <lz4.h>
+
+#define LOGURU_WITH_STREAMS 1
+#include <loguru/loguru.hpp>
+
+uint64_t hashAssetPath(string_view path) {
+    uint64_t hash = 14695981039346656037ull;
+    for(char c : path) {
+        hash ^= uint8_t(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+AssetArchive::AssetArchive(int fd, const uint8_t *data, size_t byteSize) : fd(fd), data(data), byteSize(byteSize) {
+    header = reinterpret_cast<const AssetArchiveHeader*>(data);
+    blocks = reinterpret_cast<const AssetArchiveBlock*>(data + header->blockTableOffset);
+    entries = reinterpret_cast<const AssetArchiveEntry*>(data + header->entryTableOffset);
+    paths = reinterpret_cast<const char*>(data + header->pathTableOffset);
+}
+
+unique_ptr<AssetArchive> AssetArchive::open(const string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        LOG_S(ERROR) << "couldn't open asset archive " << path;
+        return nullptr;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(AssetArchiveHeader)) {
+        LOG_S(ERROR) << path << " is not an asset archive";
+        close(fd);
+        return nullptr;
+    }
+    size_t byteSize = info.st_size;
+    void* mapped = mmap(nullptr, byteSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapped == MAP_FAILED) {
+        LOG_S(ERROR) << "couldn't map asset archive " << path;
+        close(fd);
+        return nullptr;
+    }
+    // blocks are read wherever the files which are loaded happen to be
+    madvise(mapped, byteSize, MADV_RANDOM);
+    auto data = static_cast<const uint8_t*>(mapped);
+
+    auto fail = [&](const char* reason) -> unique_ptr<AssetArchive> {
+        LOG_S(ERROR) << path << " " << reason;
+        munmap(mapped, byteSize);
+        close(fd);
+        return nullptr;
+    };
+
+    auto header = reinterpret_cast<const AssetArchiveHeader*>(data);
+    if(memcmp(header->magic, ASSET_ARCHIVE_MAGIC, sizeof(header->magic)) != 0) {
+        return fail("is not an asset archive");
+    }
+    if(header->version != ASSET_ARCHIVE_VERSION || header->blockSize == 0) {
+        return fail("has an unsupported version");
+    }
+    if(header->blockTableOffset + sizeof(AssetArchiveBlock) * header->numBlocks > byteSize ||
+       header->entryTableOffset + sizeof(AssetArchiveEntry) * header->numEntries > byteSize ||
+       header->pathTableOffset > byteSize) {
+        return fail("is truncated");
+    }
+
+    // validated once here, so reads don't have to
+    auto blocks = reinterpret_cast<const AssetArchiveBlock*>(data + header->blockTableOffset);
+    auto entries = reinterpret_cast<const AssetArchiveEntry*>(data + header->entryTableOffset);
+    for(uint32_t i = 0; i < header->numBlocks; i++) {
+        if(blocks[i].byteOffset + blocks[i].compressedSize > byteSize) {
+            return fail("has a block outside of the file");
+        }
+    }
+    for(uint32_t i = 0; i < header->numEntries; i++) {
+        const AssetArchiveEntry& entry = entries[i];
+        if(uint64_t(entry.firstBlock) + entry.numBlocks > header->numBlocks ||
+           entry.numBlocks != (entry.size + header->blockSize - 1) / header->blockSize ||
+           header->pathTableOffset + entry.pathOffset + entry.pathLength > byteSize) {
+            return fail("has an invalid entry");
+        }
+    }
+
+    LOG_S(INFO) << "mounted asset archive " << path << " (" << header->numEntries << " files)";
+    return unique_ptr<AssetArchive>(new AssetArchive(fd, data, byteSize));
+}
+
+AssetArchive::~AssetArchive() {
+    munmap(const_cast<uint8_t*>(data), byteSize);
+    close(fd);
+}
+
+const AssetArchiveEntry *AssetArchive::find(string_view path) const {
+    uint64_t hash = hashAssetPath(path);
+    const AssetArchiveEntry* end = entries + header->numEntries;
+    auto it = lower_bound(entries, end, hash, [](const AssetArchiveEntry& entry, uint64_t hash) {
+        return entry.pathHash < hash;
+    });
+    // the path is compared too, in case two of them share a hash
+    for(; it != end && it->pathHash == hash; it++) {
+        if(getPath(*it) == path) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+string_view AssetArchive::getPath(const AssetArchiveEntry &entry) const {
+    return string_view(paths + entry.pathOffset, entry.pathLength);
+}
+
+size_t AssetArchive::getBlockSize(const AssetArchiveEntry &entry, uint32_t block) const {
+    return min<uint64_t>(header->blockSize, entry.size - uint64_t(block) * header->blockSize);
+}
+
+bool AssetArchive::decompressBlock(uint32_t block, size_t size, uint8_t *out) const {
+    const AssetArchiveBlock& stored = blocks[block];
+    const char* source = reinterpret_cast<const char*>(data + stored.byteOffset);
+    if(stored.compressedSize == size) {
+        memcpy(out, source, size);
+        return true;
+    }
+    return LZ4_decompress_safe(source, reinterpret_cast<char*>(out), stored.compressedSize, size) == int(size);
+}
+
+bool AssetArchive::read(const AssetArchiveEntry &entry, size_t offset, size_t size, uint8_t *out, ArchiveBlockCache &cache) const {
+    if(offset + size > entry.size) {
+        return false;
+    }
+    size_t blockSize = header->blockSize;
+    while(size > 0) {
+        uint32_t block = offset / blockSize;
+        size_t withinBlock = offset % blockSize;
+        size_t thisBlockSize = getBlockSize(entry, block);
+        size_t bytes = min(size, thisBlockSize - withinBlock);
+
+        if(withinBlock == 0 && bytes == thisBlockSize) {
+            if(!decompressBlock(entry.firstBlock + block, thisBlockSize, out)) {
+                return false;
+            }
+        } else {
+            if(cache.block != entry.firstBlock + block) {
+                cache.data.resize(thisBlockSize);
+                if(!decompressBlock(entry.firstBlock + block, thisBlockSize, cache.data.data())) {
+                    cache.block = UINT32_MAX;
+                    return false;
+                }
+                cache.block = entry.firstBlock + block;
+            }
+            memcpy(out, cache.data.data() + withinBlock, bytes);
+        }
+
+        out += bytes;
+        offset += bytes;
+        size -= bytes;
+    }
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef GAME_ENGINE_ARCHIVE_H
+#define GAME_ENGINE_ARCHIVE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+// many assets packed into one file by the `asset_packer`, so loading doesn't have to open thousands of small files.
+// each file is split into `blockSize` blocks which are LZ4 compressed separately, so any part of a file
+// can be decompressed without reading it from the start.
+//
+// file layout (little endian):
+//   AssetArchiveHeader
+//   block data
+//   AssetArchiveBlock[numBlocks]
+//   AssetArchiveEntry[numEntries], sorted by `pathHash`
+//   paths, not null terminated
+
+const char ASSET_ARCHIVE_MAGIC[4] = {'A', 'P', 'A', 'K'};
+const uint32_t ASSET_ARCHIVE_VERSION = 1;
+const uint32_t ASSET_ARCHIVE_BLOCK_SIZE = 64 * 1024;
+
+struct AssetArchiveHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t blockSize;
+    uint32_t numBlocks;
+    uint32_t numEntries;
+    uint32_t padding;
+    uint64_t blockTableOffset;
+    uint64_t entryTableOffset;
+    uint64_t pathTableOffset;
+};
+
+struct AssetArchiveBlock {
+    uint64_t byteOffset;
+    // blocks which LZ4 couldn't shrink are stored as is, with `compressedSize` equal to their size
+    uint32_t compressedSize;
+    uint32_t padding;
+};
+
+struct AssetArchiveEntry {
+    uint64_t pathHash;
+    uint64_t size;
+    uint32_t firstBlock;
+    uint32_t numBlocks;
+    // relative to `pathTableOffset`
+    uint32_t pathOffset;
+    uint32_t pathLength;
+};
+
+// FNV-1a, stable across builds and platforms (unlike `std::hash`).
+// paths are relative to the asset root and use forward slashes, e.g.: "models/LSCM_bunny.obj"
+uint64_t hashAssetPath(string_view path);
+
+// the last block which was only partly read, so reading a file in small pieces doesn't decompress it again
+struct ArchiveBlockCache {
+    uint32_t block = UINT32_MAX;
+    vector<uint8_t> data;
+};
+
+// a memory mapped archive. lookups and reads are safe from any thread
+class AssetArchive {
+    int fd;
+    const uint8_t* data;
+    size_t byteSize;
+    const AssetArchiveHeader* header;
+    const AssetArchiveBlock* blocks;
+    const AssetArchiveEntry* entries;
+    const char* paths;
+
+    AssetArchive(int fd, const uint8_t* data, size_t byteSize);
+
+    size_t getBlockSize(const AssetArchiveEntry& entry, uint32_t block) const;
+    bool decompressBlock(uint32_t block, size_t size, uint8_t* out) const;
+
+public:
+    // returns `nullptr` (and logs why) if the file can't be mapped or isn't a valid archive
+    static unique_ptr<AssetArchive> open(const string& path);
+    ~AssetArchive();
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    const AssetArchiveEntry* find(string_view path) const;
+    string_view getPath(const AssetArchiveEntry& entry) const;
+
+    // decompresses `size` bytes of the entry, starting at `offset`. whole blocks go straight into `out`
+    bool read(const AssetArchiveEntry& entry, size_t offset, size_t size, uint8_t* out, ArchiveBlockCache& cache) const;
+};
+
+#endif //GAME_ENGINE_ARCHIVE_H
@@ -0,0 +1,65 @@
+#include "async.h"
+
+AsyncLoader::AsyncLoader(size_t numWorkers) {
+    for(size_t i = 0; i < numWorkers; i++) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+AsyncLoader::~AsyncLoader() {
+    {
+        lock_guard lock(workMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    workers.clear();
+}
+
+void AsyncLoader::workerLoop() {
+    while(true) {
+        function<void()> task;
+        {
+            unique_lock lock(workMutex);
+            workAvailable.wait(lock, [this]() { return stopping || !work.empty(); });
+            // queued work still runs, so every promise it holds is fulfilled
+            if(stopping && work.empty()) {
+                return;
+            }
+            task = std::move(work.front());
+            work.pop_front();
+        }
+        task();
+    }
+}
+
+void AsyncLoader::enqueueWork(function<void()> task) {
+    {
+        lock_guard lock(workMutex);
+        work.push_back(std::move(task));
+    }
+    workAvailable.notify_one();
+}
+
+void AsyncLoader::enqueueUpload(function<void()> task) {
+    {
+        lock_guard lock(uploadMutex);
+        uploads.push_back(std::move(task));
+    }
+    uploadAvailable.notify_one();
+}
+
+bool AsyncLoader::runUploads() {
+    deque<function<void()>> pending;
+    {
+        lock_guard lock(uploadMutex);
+        pending.swap(uploads);
+    }
+    for(auto& upload : pending) {
+        upload();
+    }
+    return !pending.empty();
+}
+
+void AsyncLoader::processUploads() {
+    runUploads();
+}
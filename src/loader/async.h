@@ -0,0 +1,142 @@
+#ifndef GAME_ENGINE_ASYNC_H
+#define GAME_ENGINE_ASYNC_H
+
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <type_traits>
+
+using namespace std;
+
+// a resource which may still be loading, see `AsyncLoader::wait`
+template<typename T>
+using AssetFuture = shared_future<shared_ptr<T>>;
+
+// loads assets in two phases: file I/O and decoding run on a pool of worker threads,
+// then the (usually much shorter) GL upload is queued for the context thread,
+// which runs it from `processUploads` or while it is blocked in `wait`.
+class AsyncLoader {
+    mutex workMutex;
+    condition_variable workAvailable;
+    deque<function<void()>> work;
+    bool stopping = false;
+
+    mutex uploadMutex;
+    condition_variable uploadAvailable;
+    deque<function<void()>> uploads;
+
+    // declared last, so the workers are joined before the queues are destroyed
+    vector<jthread> workers;
+
+    void workerLoop();
+    void enqueueWork(function<void()> task);
+    void enqueueUpload(function<void()> task);
+
+    // runs every queued upload, returns whether any were run
+    bool runUploads();
+
+public:
+    explicit AsyncLoader(size_t numWorkers = max(2u, thread::hardware_concurrency()) - 1);
+    // finishes the queued work first. uploads which haven't run by then never will, and their futures
+    // report a broken promise
+    ~AsyncLoader();
+
+    AsyncLoader(const AsyncLoader&) = delete;
+    AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+    // runs `task` on a worker thread, it mustn't touch the GL context
+    template<typename F>
+    shared_future<invoke_result_t<F>> run(F task) {
+        using R = invoke_result_t<F>;
+        auto promise = make_shared<std::promise<R>>();
+        shared_future<R> future = promise->get_future().share();
+
+        enqueueWork([promise, task]() mutable {
+            try {
+                promise->set_value(task());
+            } catch(...) {
+                promise->set_exception(current_exception());
+            }
+        });
+
+        return future;
+    }
+
+    // runs `decode` on a worker thread, then passes its result to `upload` on the context thread
+    template<typename D, typename U>
+    shared_future<invoke_result_t<U, invoke_result_t<D>>> runThenUpload(D decode, U upload) {
+        using Decoded = invoke_result_t<D>;
+        using R = invoke_result_t<U, Decoded>;
+        auto promise = make_shared<std::promise<R>>();
+        shared_future<R> future = promise->get_future().share();
+
+        enqueueWork([this, promise, decode, upload]() mutable {
+            try {
+                // std::function needs copyable tasks, decoded data is often move-only
+                auto decoded = make_shared<Decoded>(decode());
+                enqueueUpload([promise, decoded, upload]() mutable {
+                    try {
+                        if constexpr (is_void_v<R>) {
+                            upload(std::move(*decoded));
+                            promise->set_value();
+                        } else {
+                            promise->set_value(upload(std::move(*decoded)));
+                        }
+                    } catch(...) {
+                        promise->set_exception(current_exception());
+                    }
+                });
+            } catch(...) {
+                promise->set_exception(current_exception());
+            }
+        });
+
+        return future;
+    }
+
+    // runs `upload` on the context thread, in order with every other upload.
+    // uploads queued by another upload run on the next `processUploads`
+    template<typename U>
+    shared_future<invoke_result_t<U>> runOnContextThread(U upload) {
+        using R = invoke_result_t<U>;
+        auto promise = make_shared<std::promise<R>>();
+        shared_future<R> future = promise->get_future().share();
+
+        enqueueUpload([promise, upload]() mutable {
+            try {
+                if constexpr (is_void_v<R>) {
+                    upload();
+                    promise->set_value();
+                } else {
+                    promise->set_value(upload());
+                }
+            } catch(...) {
+                promise->set_exception(current_exception());
+            }
+        });
+
+        return future;
+    }
+
+    // must be called on the context thread, e.g.: once per frame
+    void processUploads();
+
+    // must be called on the context thread. keeps running uploads until `future` is ready
+    template<typename T>
+    T wait(const shared_future<T>& future) {
+        while(future.wait_for(chrono::seconds(0)) != future_status::ready) {
+            if(!runUploads()) {
+                unique_lock lock(uploadMutex);
+                uploadAvailable.wait_for(lock, chrono::milliseconds(1), [this]() { return !uploads.empty(); });
+            }
+        }
+        return future.get();
+    }
+};
+
+#endif //GAME_ENGINE_ASYNC_H
@@ -0,0 +1,77 @@
+#include "atlas.h"
+
+#include <map>
+#include <tuple>
+
+#define LOGURU_WITH_STREAMS 1
+#include <loguru/loguru.hpp>
+
+// textures can only share an array if all of these match
+using ArrayKey = tuple<DataFormat, uint32_t, uint32_t, size_t>;
+
+static ArrayKey getArrayKey(const DecodedTexture& decoded) {
+    if(auto cooked = get_if<CookedTexture>(&decoded)) {
+        return { getCookedDataFormat(cooked->format), cooked->width, cooked->height, cooked->levels.size() };
+    }
+    auto& image = get<DecodedImage>(decoded);
+    return { getImageFormats(image.numComponents).first, image.size.width, image.size.height, image.mipLevels.size() + 1 };
+}
+
+static void uploadLayer(OpenGLContext& context, Texture2dArray& array, uint32_t layer, const DecodedTexture& decoded) {
+    if(auto cooked = get_if<CookedTexture>(&decoded)) {
+        for(uint32_t level = 0; level < cooked->levels.size(); level++) {
+            context.uploadCompressedLayer(array, layer, level, cooked->getLevelData(level), cooked->levels[level].byteSize);
+        }
+        return;
+    }
+
+    auto& image = get<DecodedImage>(decoded);
+    TransferFormat transferFormat = getImageFormats(image.numComponents).second;
+    context.uploadLayer(array, layer, 0, transferFormat, image.pixels.get());
+    for(uint32_t level = 0; level < image.mipLevels.size(); level++) {
+        context.uploadLayer(array, layer, level + 1, transferFormat, image.mipLevels[level].pixels.data());
+    }
+}
+
+TextureAtlas TextureAtlas::build(OpenGLContext &context, vector<DecodedTexture> textures, uint32_t maxLayers) {
+    map<ArrayKey, vector<size_t>> groups;
+    for(size_t i = 0; i < textures.size(); i++) {
+        groups[getArrayKey(textures[i])].push_back(i);
+    }
+
+    TextureAtlas atlas;
+    atlas.slots.resize(textures.size());
+    for(auto& [key, members] : groups) {
+        auto [format, width, height, numLevels] = key;
+
+        for(size_t first = 0; first < members.size(); first += maxLayers) {
+            uint32_t numLayers = min<size_t>(maxLayers, members.size() - first);
+            auto array = make_shared<Texture2dArray>(context.buildTexture2DArray(format, Dimensions2d(width, height), numLayers, numLevels > 1));
+
+            for(uint32_t layer = 0; layer < numLayers; layer++) {
+                size_t texture = members[first + layer];
+                uploadLayer(context, *array, layer, textures[texture]);
+                atlas.slots[texture] = TextureArraySlot { .array = array, .layer = layer };
+            }
+            atlas.arrays.push_back(array);
+        }
+    }
+
+    LOG_S(INFO) << "packed " << textures.size() << " textures into " << atlas.arrays.size() << " texture arrays";
+    return atlas;
+}
+
+AssetFuture<TextureAtlas> TextureAtlas::load(AsyncLoader &loader, OpenGLContext &context, vector<Texture2dMetadata> textures, uint32_t maxLayers) {
+    return loader.runThenUpload(
+        [textures]() {
+            vector<DecodedTexture> decoded;
+            decoded.reserve(textures.size());
+            for(auto& metadata : textures) {
+                decoded.push_back(metadata.decode());
+            }
+            return decoded;
+        },
+        [&context, maxLayers](vector<DecodedTexture> decoded) {
+            return make_shared<TextureAtlas>(build(context, std::move(decoded), maxLayers));
+        });
+}
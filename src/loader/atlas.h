@@ -0,0 +1,38 @@
+#ifndef GAME_ENGINE_ATLAS_H
+#define GAME_ENGINE_ATLAS_H
+
+#include <vector>
+#include <memory>
+#include "../graphics/texturing.h"
+#include "../graphics/OpenGLContext.h"
+#include "texture.h"
+#include "async.h"
+
+using namespace std;
+
+// stays well below GL_MAX_ARRAY_TEXTURE_LAYERS (at least 2048)
+const uint32_t DEFAULT_MAX_ATLAS_LAYERS = 256;
+
+// where a texture ended up
+struct TextureArraySlot {
+    shared_ptr<Texture2dArray> array;
+    uint32_t layer;
+};
+
+// packs textures which share a format, size and mip count into texture arrays, one texture per layer.
+// materials whose textures landed in the same array can be drawn without rebinding anything,
+// by passing their layer index to the shader instead.
+class TextureAtlas {
+public:
+    // in the same order as the textures which were packed
+    vector<TextureArraySlot> slots;
+    vector<shared_ptr<Texture2dArray>> arrays;
+
+    // must be called on the context thread
+    static TextureAtlas build(OpenGLContext& context, vector<DecodedTexture> textures, uint32_t maxLayers = DEFAULT_MAX_ATLAS_LAYERS);
+
+    // decodes the textures on a worker thread, then builds the atlas on the context thread
+    static AssetFuture<TextureAtlas> load(AsyncLoader& loader, OpenGLContext& context, vector<Texture2dMetadata> textures, uint32_t maxLayers = DEFAULT_MAX_ATLAS_LAYERS);
+};
+
+#endif //GAME_ENGINE_ATLAS_H
@@ -1,27 +1,166 @@
 
 
-#pragma once    
+#pragma once
 
 #include <memory>
+#include <future>
+#include <list>
+#include <limits>
+#include <chrono>
 #include "../graphics/Shader.h"
 #include "../graphics/OpenGLContext.h"
+#include "async.h"
 
+struct ResourceCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    // of the loaded resources the cache still holds. an evicted resource stops counting here even if it's still
+    // alive elsewhere, e.g.: through a copy of its `AssetFuture`, so this (and the budget) can under-count residency
+    size_t residentBytes = 0;
+};
+
+// `Metadata` must provide `getKey()` and `build(context)`. if it also provides `decode()` and
+// `upload(context, decoded)`, `load` will run `decode()` on a worker thread.
+// resources which provide `getByteSize()` count towards the byte budget. once it's exceeded, resources
+// which nobody else holds on to are evicted, least recently used first.
 template<typename K, typename T>
 class ResourceCache {
+    struct Entry {
+        AssetFuture<T> future;
+        // position in `recentlyUsed`
+        typename list<K>::iterator lru;
+        // only known once the resource has finished loading
+        size_t bytes = 0;
+        bool counted = false;
+    };
+
     OpenGLContext& context;
-    unordered_map<K, shared_ptr<T>> cache;
+    AsyncLoader& loader;
+    size_t budgetBytes;
+    unordered_map<K, Entry> cache;
+    // most recently used at the front
+    list<K> recentlyUsed;
+    // entries which are still loading, so their size hasn't been counted yet
+    size_t numUncounted = 0;
+    ResourceCacheStats stats;
+
+    static bool isReady(const AssetFuture<T>& future) {
+        return future.wait_for(chrono::seconds(0)) == future_status::ready;
+    }
+
+    static size_t getBytes(const T& resource) {
+        if constexpr (requires(const T t) { t.getByteSize(); }) {
+            return resource.getByteSize();
+        } else {
+            return 0;
+        }
+    }
+
+    void countLoadedEntries() {
+        if(numUncounted == 0) {
+            return;
+        }
+        for(auto& [key, entry] : cache) {
+            if(!entry.counted && isReady(entry.future)) {
+                try {
+                    shared_ptr<T> resource = entry.future.get();
+                    entry.bytes = resource ? getBytes(*resource) : 0;
+                } catch(...) {
+                    // failed loads are reported to whoever waits on them
+                    entry.bytes = 0;
+                }
+                entry.counted = true;
+                stats.residentBytes += entry.bytes;
+                numUncounted--;
+            }
+        }
+    }
+
+    // returns the entry and whether it has just been inserted (and still needs its future set)
+    pair<Entry&, bool> lookup(const K& key) {
+        auto [it, inserted] = cache.try_emplace(key);
+        Entry& entry = it->second;
+        if(inserted) {
+            stats.misses++;
+            numUncounted++;
+            recentlyUsed.push_front(key);
+            entry.lru = recentlyUsed.begin();
+        } else {
+            stats.hits++;
+            recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, entry.lru);
+        }
+        return { entry, inserted };
+    }
+
 public:
 
-    ResourceCache(OpenGLContext& context) : context(context) {}
+    ResourceCache(OpenGLContext& context, AsyncLoader& loader, size_t budgetBytes = numeric_limits<size_t>::max())
+        : context(context), loader(loader), budgetBytes(budgetBytes) {}
 
+    // must be called on the context thread. blocks until the resource is ready, building it here if nobody has requested it yet.
     template<typename Metadata>
     shared_ptr<T> get(Metadata metadata) {
-        auto key = metadata.getKey();
-        auto it = cache.find(key);
-        if(it == cache.end()) {
-            cache[key] = metadata.build(context);
+        auto [entry, inserted] = lookup(metadata.getKey());
+        if(inserted) {
+            promise<shared_ptr<T>> built;
+            try {
+                built.set_value(metadata.build(context));
+            } catch(...) {
+                built.set_exception(current_exception());
+            }
+            entry.future = built.get_future().share();
+        }
+
+        shared_ptr<T> resource = loader.wait(entry.future);
+        trim();
+        return resource;
+    }
+
+    // starts loading the resource in the background (unless it is already loaded or loading)
+    template<typename Metadata>
+    AssetFuture<T> load(Metadata metadata) {
+        auto [entry, inserted] = lookup(metadata.getKey());
+        if(!inserted) {
+            return entry.future;
+        }
+
+        if constexpr (requires(const Metadata m) { m.decode(); }) {
+            entry.future = loader.runThenUpload(
+                [metadata]() { return metadata.decode(); },
+                [metadata, this](auto decoded) { return metadata.upload(context, std::move(decoded)); });
+        } else {
+            entry.future = loader.runOnContextThread([metadata, this]() mutable { return metadata.build(context); });
+        }
+        AssetFuture<T> future = entry.future;
+        trim();
+        return future;
+    }
+
+    // evicts unused resources, least recently used first, until the cache fits in its budget again.
+    // happens automatically on `get` and `load`, but resources only become unused once they are released elsewhere
+    void trim() {
+        countLoadedEntries();
+        for(auto it = recentlyUsed.end(); it != recentlyUsed.begin() && stats.residentBytes > budgetBytes; ) {
+            --it;
+            auto entry = cache.find(*it);
+            // evicting empty entries wouldn't help. the cache's own reference lives in the future's shared state, which
+            // copies of the future share, so a resource only held through those is evicted while it stays alive
+            if(!entry->second.counted || entry->second.bytes == 0 || entry->second.future.get().use_count() > 1) {
+                continue;
+            }
+            stats.residentBytes -= entry->second.bytes;
+            stats.evictions++;
+            cache.erase(entry);
+            it = recentlyUsed.erase(it);
         }
+    }
+
+    const ResourceCacheStats& getStats() const {
+        return stats;
+    }
 
-        return cache[key];
+    size_t getBudgetBytes() const {
+        return budgetBytes;
     }
-};
\ No newline at end of file
+};
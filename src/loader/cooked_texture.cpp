@@ -0,0 +1,85 @@
+#include "cooked_texture.h"
+
+#include <fstream>
+#include <cstring>
+
+#define LOGURU_WITH_STREAMS 1
+#include <loguru/loguru.hpp>
+
+size_t cookedFormatBlockSize(CookedFormat format) {
+    switch(format) {
+        case CookedFormat::BC1_RGB:
+        case CookedFormat::BC4_R:
+            return 8;
+        case CookedFormat::BC3_RGBA:
+        case CookedFormat::BC5_RG:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+bool isCookedTexturePath(const string& path) {
+    size_t extensionLength = strlen(COOKED_TEXTURE_EXTENSION);
+    return path.size() >= extensionLength && path.compare(path.size() - extensionLength, extensionLength, COOKED_TEXTURE_EXTENSION) == 0;
+}
+
+optional<CookedTexture> readCookedTexture(AssetFile& file, const string& path) {
+    size_t fileSize = file.getSize();
+
+    CookedTextureHeader header;
+    if(fileSize < sizeof(header) || !file.read(0, sizeof(header), &header) || memcmp(header.magic, COOKED_TEXTURE_MAGIC, sizeof(header.magic)) != 0) {
+        LOG_S(ERROR) << path << " is not a cooked texture";
+        return nullopt;
+    }
+    if(header.version != COOKED_TEXTURE_VERSION || cookedFormatBlockSize(header.format) == 0) {
+        LOG_S(ERROR) << path << " has unsupported version " << header.version << " or format " << static_cast<uint32_t>(header.format);
+        return nullopt;
+    }
+
+    CookedTexture texture {
+        .format = header.format,
+        .width = header.width,
+        .height = header.height,
+        .levels = vector<CookedMipLevel>(header.numLevels)
+    };
+    size_t levelTableSize = sizeof(CookedMipLevel) * header.numLevels;
+    if(sizeof(header) + levelTableSize > fileSize || !file.read(sizeof(header), levelTableSize, texture.levels.data())) {
+        LOG_S(ERROR) << path << " is truncated";
+        return nullopt;
+    }
+
+    texture.data.resize(fileSize - sizeof(header) - levelTableSize);
+    if(!file.read(sizeof(header) + levelTableSize, texture.data.size(), texture.data.data())) {
+        LOG_S(ERROR) << "couldn't read " << path;
+        return nullopt;
+    }
+
+    for(auto& level : texture.levels) {
+        if(level.byteOffset + level.byteSize > texture.data.size()) {
+            LOG_S(ERROR) << path << " has a mip level outside of the file";
+            return nullopt;
+        }
+    }
+
+    return texture;
+}
+
+bool writeCookedTexture(const string& path, const CookedTexture& texture) {
+    ofstream file(path, ios::binary | ios::trunc);
+
+    CookedTextureHeader header {
+        .version = COOKED_TEXTURE_VERSION,
+        .format = texture.format,
+        .width = texture.width,
+        .height = texture.height,
+        .numLevels = static_cast<uint32_t>(texture.levels.size())
+    };
+    memcpy(header.magic, COOKED_TEXTURE_MAGIC, sizeof(header.magic));
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(texture.levels.data()), sizeof(CookedMipLevel) * texture.levels.size());
+    file.write(reinterpret_cast<const char*>(texture.data.data()), texture.data.size());
+
+    return file.good();
+}
@@ -0,0 +1,69 @@
+#ifndef GAME_ENGINE_COOKED_TEXTURE_H
+#define GAME_ENGINE_COOKED_TEXTURE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optional>
+#include "vfs.h"
+
+using namespace std;
+
+// textures produced offline by the `texture_cooker`, with every mip level already
+// block-compressed, so loading them is just a file read and `glCompressedTexSubImage2D`.
+//
+// file layout (little endian):
+//   CookedTextureHeader
+//   CookedMipLevel[numLevels], largest level first
+//   level data, at `byteOffset`s relative to the end of the level table
+
+const char COOKED_TEXTURE_MAGIC[4] = {'C', 'T', 'E', 'X'};
+const uint32_t COOKED_TEXTURE_VERSION = 1;
+const char* const COOKED_TEXTURE_EXTENSION = ".ctex";
+
+// values are stored in files, only ever append
+enum class CookedFormat : uint32_t {
+    BC1_RGB = 0,  // 4 bits per texel, colour without alpha
+    BC3_RGBA = 1, // 8 bits per texel, colour and alpha
+    BC4_R = 2,    // 4 bits per texel, single channel
+    BC5_RG = 3    // 8 bits per texel, two channels, e.g.: normal map XY
+};
+
+struct CookedTextureHeader {
+    char magic[4];
+    uint32_t version;
+    CookedFormat format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t numLevels;
+};
+
+struct CookedMipLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t byteOffset;
+    uint64_t byteSize;
+};
+
+struct CookedTexture {
+    CookedFormat format;
+    uint32_t width;
+    uint32_t height;
+    vector<CookedMipLevel> levels;
+    vector<uint8_t> data;
+
+    const uint8_t* getLevelData(size_t level) const {
+        return data.data() + levels[level].byteOffset;
+    }
+};
+
+// bytes in one 4x4 block
+size_t cookedFormatBlockSize(CookedFormat format);
+
+bool isCookedTexturePath(const string& path);
+
+// returns `nullopt` (and logs why) if the file can't be read or isn't a valid cooked texture
+optional<CookedTexture> readCookedTexture(AssetFile& file, const string& path);
+bool writeCookedTexture(const string& path, const CookedTexture& texture);
+
+#endif //GAME_ENGINE_COOKED_TEXTURE_H
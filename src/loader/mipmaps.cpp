@@ -0,0 +1,221 @@
+#include "mipmaps.h"
+#include "../parallel.h"
+
+#include <cmath>
+#include <cassert>
+#include <array>
+#include <algorithm>
+#include <immintrin.h>
+
+// below this many rows it isn't worth handing a level to other threads
+const size_t MIP_ROWS_GRAIN = 32;
+
+// for `linearToSrgb`, fine enough that every 8-bit sRGB value is reachable
+const int LINEAR_TABLE_SIZE = 1 << 16;
+
+// levels are filtered as one float per channel, always 4 channels so a texel fits an SSE register
+struct LinearImage {
+    uint32_t width;
+    uint32_t height;
+    vector<float> texels;
+
+    __m128 load(size_t i) const {
+        return _mm_loadu_ps(&texels[i * 4]);
+    }
+
+    void store(size_t i, __m128 texel) {
+        _mm_storeu_ps(&texels[i * 4], texel);
+    }
+
+    __m128 at(uint32_t x, uint32_t y) const {
+        return load(size_t(min(y, height - 1)) * width + min(x, width - 1));
+    }
+};
+
+struct ColorTables {
+    float srgbToLinear[256];
+    uint8_t linearToSrgb[LINEAR_TABLE_SIZE];
+
+    ColorTables() {
+        for(int i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            srgbToLinear[i] = c <= 0.04045f ? c / 12.92f : pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for(int i = 0; i < LINEAR_TABLE_SIZE; i++) {
+            float l = i / float(LINEAR_TABLE_SIZE - 1);
+            float c = l <= 0.0031308f ? l * 12.92f : 1.055f * pow(l, 1.0f / 2.4f) - 0.055f;
+            linearToSrgb[i] = static_cast<uint8_t>(clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+    }
+};
+
+static const ColorTables& getColorTables() {
+    static ColorTables tables;
+    return tables;
+}
+
+// the channels which hold colour, as opposed to alpha
+static int getNumColorChannels(int numComponents) {
+    return numComponents == 2 || numComponents == 4 ? numComponents - 1 : numComponents;
+}
+
+static LinearImage toLinear(const uint8_t* pixels, uint32_t width, uint32_t height, int numComponents, ColorSpace colorSpace) {
+    const ColorTables& tables = getColorTables();
+    int numColorChannels = colorSpace == ColorSpace::SRGB ? getNumColorChannels(numComponents) : 0;
+
+    LinearImage image { .width = width, .height = height, .texels = vector<float>(size_t(width) * height * 4) };
+    parallelForRanges(height, MIP_ROWS_GRAIN, [&](size_t begin, size_t end) {
+        for(size_t i = begin * width; i < end * width; i++) {
+            alignas(16) float texel[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for(int c = 0; c < numComponents; c++) {
+                uint8_t value = pixels[i * numComponents + c];
+                texel[c] = c < numColorChannels ? tables.srgbToLinear[value] : value / 255.0f;
+            }
+            image.store(i, _mm_load_ps(texel));
+        }
+    });
+    return image;
+}
+
+static MipLevel fromLinear(const LinearImage& image, int numComponents, ColorSpace colorSpace) {
+    const ColorTables& tables = getColorTables();
+    int numColorChannels = colorSpace == ColorSpace::SRGB ? getNumColorChannels(numComponents) : 0;
+
+    MipLevel level { .width = image.width, .height = image.height, .pixels = vector<uint8_t>(size_t(image.width) * image.height * numComponents) };
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 linearScale = _mm_set1_ps(float(LINEAR_TABLE_SIZE - 1));
+    const __m128 unormScale = _mm_set1_ps(255.0f);
+
+    parallelForRanges(image.height, MIP_ROWS_GRAIN, [&](size_t begin, size_t end) {
+        for(size_t i = begin * image.width; i < end * image.width; i++) {
+            // sharper filters overshoot, so clamp first
+            __m128 texel = _mm_min_ps(_mm_max_ps(image.load(i), zero), one);
+            alignas(16) int32_t tableIndices[4];
+            alignas(16) int32_t unorm[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(tableIndices), _mm_cvtps_epi32(_mm_mul_ps(texel, linearScale)));
+            _mm_store_si128(reinterpret_cast<__m128i*>(unorm), _mm_cvtps_epi32(_mm_mul_ps(texel, unormScale)));
+
+            for(int c = 0; c < numComponents; c++) {
+                level.pixels[i * numComponents + c] = c < numColorChannels ? tables.linearToSrgb[tableIndices[c]] : static_cast<uint8_t>(unorm[c]);
+            }
+        }
+    });
+    return level;
+}
+
+static LinearImage downsampleBox(const LinearImage& image) {
+    LinearImage result { .width = max(1u, image.width / 2), .height = max(1u, image.height / 2) };
+    result.texels.resize(size_t(result.width) * result.height * 4);
+
+    const __m128 quarter = _mm_set1_ps(0.25f);
+    parallelForRanges(result.height, MIP_ROWS_GRAIN, [&](size_t begin, size_t end) {
+        for(uint32_t y = begin; y < end; y++) {
+            for(uint32_t x = 0; x < result.width; x++) {
+                __m128 sum = _mm_add_ps(_mm_add_ps(image.at(x * 2, y * 2), image.at(x * 2 + 1, y * 2)),
+                                        _mm_add_ps(image.at(x * 2, y * 2 + 1), image.at(x * 2 + 1, y * 2 + 1)));
+                result.store(size_t(y) * result.width + x, _mm_mul_ps(sum, quarter));
+            }
+        }
+    });
+    return result;
+}
+
+// zeroth order modified bessel function of the first kind
+static double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for(int k = 1; k < 20; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+const int KAISER_TAPS = 6;
+
+// weights of the source texels 2x - 2 ... 2x + 3 for destination texel x
+static const array<float, KAISER_TAPS>& getKaiserWeights() {
+    static array<float, KAISER_TAPS> weights = []() {
+        const double alpha = 4.0;
+        const double radius = KAISER_TAPS / 2;
+        array<float, KAISER_TAPS> w;
+        double total = 0.0;
+        for(int i = 0; i < KAISER_TAPS; i++) {
+            // distance from the destination texel's centre, in source texels
+            double d = i - KAISER_TAPS / 2 + 0.5;
+            double t = d / 2.0;
+            double sinc = sin(M_PI * t) / (M_PI * t);
+            double window = besselI0(alpha * sqrt(1.0 - (d / radius) * (d / radius))) / besselI0(alpha);
+            w[i] = sinc * window;
+            total += w[i];
+        }
+        for(auto& weight : w) {
+            weight /= total;
+        }
+        return w;
+    }();
+    return weights;
+}
+
+// separable, horizontally and then vertically
+static LinearImage downsampleKaiser(const LinearImage& image) {
+    const array<float, KAISER_TAPS>& weights = getKaiserWeights();
+    __m128 w[KAISER_TAPS];
+    for(int i = 0; i < KAISER_TAPS; i++) {
+        w[i] = _mm_set1_ps(weights[i]);
+    }
+    const int firstTap = KAISER_TAPS / 2 - 1;
+
+    auto sourceIndex = [](int64_t i, uint32_t size) {
+        return uint32_t(clamp<int64_t>(i, 0, size - 1));
+    };
+
+    LinearImage horizontal { .width = max(1u, image.width / 2), .height = image.height };
+    horizontal.texels.resize(size_t(horizontal.width) * horizontal.height * 4);
+    parallelForRanges(horizontal.height, MIP_ROWS_GRAIN, [&](size_t begin, size_t end) {
+        for(uint32_t y = begin; y < end; y++) {
+            size_t row = size_t(y) * image.width;
+            for(uint32_t x = 0; x < horizontal.width; x++) {
+                __m128 sum = _mm_setzero_ps();
+                for(int i = 0; i < KAISER_TAPS; i++) {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(image.load(row + sourceIndex(int64_t(x) * 2 - firstTap + i, image.width)), w[i]));
+                }
+                horizontal.store(size_t(y) * horizontal.width + x, sum);
+            }
+        }
+    });
+
+    LinearImage result { .width = horizontal.width, .height = max(1u, image.height / 2) };
+    result.texels.resize(size_t(result.width) * result.height * 4);
+    parallelForRanges(result.height, MIP_ROWS_GRAIN, [&](size_t begin, size_t end) {
+        for(uint32_t y = begin; y < end; y++) {
+            size_t rows[KAISER_TAPS];
+            for(int i = 0; i < KAISER_TAPS; i++) {
+                rows[i] = size_t(sourceIndex(int64_t(y) * 2 - firstTap + i, horizontal.height)) * horizontal.width;
+            }
+            for(uint32_t x = 0; x < result.width; x++) {
+                __m128 sum = _mm_setzero_ps();
+                for(int i = 0; i < KAISER_TAPS; i++) {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(horizontal.load(rows[i] + x), w[i]));
+                }
+                result.store(size_t(y) * result.width + x, sum);
+            }
+        }
+    });
+    return result;
+}
+
+vector<MipLevel> generateMipLevels(const uint8_t* pixels, uint32_t width, uint32_t height, int numComponents,
+                                   ColorSpace colorSpace, MipFilter filter) {
+    assert(numComponents >= 1 && numComponents <= 4);
+
+    vector<MipLevel> levels;
+    // filtering always starts from the unquantized previous level
+    LinearImage current = toLinear(pixels, width, height, numComponents, colorSpace);
+    while(current.width > 1 || current.height > 1) {
+        current = filter == MipFilter::KAISER ? downsampleKaiser(current) : downsampleBox(current);
+        levels.push_back(fromLinear(current, numComponents, colorSpace));
+    }
+    return levels;
+}
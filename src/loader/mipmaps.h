@@ -0,0 +1,34 @@
+#ifndef GAME_ENGINE_MIPMAPS_H
+#define GAME_ENGINE_MIPMAPS_H
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// how the 8-bit colour channels of an image are encoded. alpha is always linear
+enum class ColorSpace {
+    SRGB,
+    LINEAR // e.g.: normal maps, roughness
+};
+
+enum class MipFilter {
+    BOX,
+    // windowed sinc, sharper than `BOX` without much ringing
+    KAISER
+};
+
+struct MipLevel {
+    uint32_t width;
+    uint32_t height;
+    vector<uint8_t> pixels;
+};
+
+// generates every level below the base image, down to 1x1, in the same tightly packed
+// layout (`numComponents` 8-bit channels per texel) as `pixels`.
+// sRGB channels are filtered in linear space. rows of each level are filtered in
+// parallel, so this is best called from a loader thread.
+vector<MipLevel> generateMipLevels(const uint8_t* pixels, uint32_t width, uint32_t height, int numComponents,
+                                   ColorSpace colorSpace, MipFilter filter = MipFilter::KAISER);
+
+#endif //GAME_ENGINE_MIPMAPS_H
@@ -1,11 +1,83 @@
 
 #include "models.h"
 
+#include <cstring>
+#include <assimp/IOSystem.hpp>
+#include <assimp/IOStream.hpp>
 #include "../../gen/shaders/textured.h"
+#include "vfs.h"
+
+// lets assimp read models (and the files they reference, e.g.: `.mtl`s) through the `AssetFileSystem`
+class AssetIOStream : public Assimp::IOStream {
+    unique_ptr<AssetFile> file;
+    size_t position = 0;
+public:
+    AssetIOStream(unique_ptr<AssetFile> file) : file(std::move(file)) {}
+
+    size_t Read(void* buffer, size_t size, size_t count) override {
+        if(size == 0) {
+            return 0;
+        }
+        size_t readable = min(count, (file->getSize() - position) / size);
+        if(!file->read(position, readable * size, buffer)) {
+            return 0;
+        }
+        position += readable * size;
+        return readable;
+    }
+
+    // assets are read-only
+    size_t Write(const void*, size_t, size_t) override {
+        return 0;
+    }
+
+    aiReturn Seek(size_t offset, aiOrigin origin) override {
+        size_t target = origin == aiOrigin_SET ? offset : origin == aiOrigin_CUR ? position + offset : file->getSize() + offset;
+        if(target > file->getSize()) {
+            return aiReturn_FAILURE;
+        }
+        position = target;
+        return aiReturn_SUCCESS;
+    }
+
+    size_t Tell() const override {
+        return position;
+    }
+
+    size_t FileSize() const override {
+        return file->getSize();
+    }
+
+    void Flush() override {}
+};
 
+class AssetIOSystem : public Assimp::IOSystem {
+public:
+    bool Exists(const char* path) const override {
+        return getAssetFileSystem().exists(path);
+    }
 
+    char getOsSeparator() const override {
+        return '/';
+    }
+
+    Assimp::IOStream* Open(const char* path, const char* mode) override {
+        if(strpbrk(mode, "wa+") != nullptr) {
+            LOG_S(ERROR) << "can't open " << path << " for writing, assets are read-only";
+            return nullptr;
+        }
+        unique_ptr<AssetFile> file = getAssetFileSystem().open(path);
+        return file ? new AssetIOStream(std::move(file)) : nullptr;
+    }
+
+    void Close(Assimp::IOStream* stream) override {
+        delete stream;
+    }
+};
 
 Model::Model(const char *filepath) {
+    // the importer takes ownership
+    importer.SetIOHandler(new AssetIOSystem());
     scene = importer.ReadFile(filepath,
             aiProcess_GenSmoothNormals            |
             aiProcess_CalcTangentSpace      |
@@ -45,19 +117,49 @@ Model::Model(const char *filepath) {
         cout << "found mesh: " << mesh->mName.C_Str() << endl;
         cout << "vertices: " << mesh->mNumVertices << endl;
 
+        meshVertexOffsets.push_back(totalVertices);
+        BoundingBox meshBox;
+        for (size_t k = 0; k < mesh->mNumVertices; k++) {
+            meshBox.extend(glm::vec3(mesh->mVertices[k].x, mesh->mVertices[k].y, mesh->mVertices[k].z));
+        }
+        meshBounds.push_back(meshBox);
+        bounds.extend(meshBox);
         totalVertices += mesh->mNumVertices;
         totalIndices += mesh->mNumFaces * 3;
     }
 }
 
 IndexFormat Model::getPreferredIndexFormat() {
-    if(totalVertices < SHRT_MAX) {
+    if(totalVertices <= size_t(numeric_limits<uint16_t>::max()) + 1) {
         return IndexFormat::UINT16;
     } else {
         return IndexFormat::UINT32;
     }
 }
 
+void Model::checkAttributes(RequiredAttributes required) {
+    for (int i = 0; i < scene->mNumMeshes; i++) {
+        aiMesh *mesh = scene->mMeshes[i];
+        if (required.normals && mesh->mNormals == nullptr) {
+            LOG_S(ERROR) << "mesh " << mesh->mName.C_Str() << ": expected normals, found none";
+        }
+        if (required.tangents && mesh->mTangents == nullptr) {
+            LOG_S(ERROR) << "mesh " << mesh->mName.C_Str() << ": expected tangents, found none";
+        }
+        if (required.textureCoordinates && mesh->mNumUVComponents[0] < 1) {
+            LOG_S(ERROR) << "mesh " << mesh->mName.C_Str() << ": expected tex coords, found none";
+        }
+    }
+}
+
+const BoundingBox& Model::getBounds() const {
+    return bounds;
+}
+
+const BoundingBox& Model::getMeshBounds(size_t mesh) const {
+    return meshBounds[mesh];
+}
+
 size_t Model::getNumIndices() {
     return totalIndices;
 }
@@ -66,25 +168,32 @@ size_t Model::getNumVertices() {
     return totalVertices;
 }
 
-void Model::writeIndices(span<uint32_t> thisBuffer) {
-    assert(thisBuffer.size() >= totalIndices);
-
-    int idx = 0;
-    for (int i = 0; i < scene->mNumMeshes; i++) {
-        aiMesh *mesh = scene->mMeshes[i];
-
-        for (int k = 0; k < mesh->mNumFaces; k++) {
-            aiFace face = mesh->mFaces[k];
+size_t Model::getIndexBufferSize() {
+    return totalIndices * indexFormatGetBytes(getPreferredIndexFormat());
+}
 
-            for (int j = 0; j < face.mNumIndices; j++) {
-                int index = face.mIndices[j];
+Slice Model::writeIndices(span<uint8_t> buffer, size_t& byteOffset) {
+    IndexFormat format = getPreferredIndexFormat();
+    size_t indexSize = indexFormatGetBytes(format);
+    size_t elementOffset = (byteOffset + indexSize - 1) / indexSize;
+    assert((elementOffset + totalIndices) * indexSize <= buffer.size());
 
-                thisBuffer[idx++] = index;
-            }
-        }
+    uint8_t *dest = buffer.data() + elementOffset * indexSize;
+    if(format == IndexFormat::UINT16) {
+        writeIndices(span(reinterpret_cast<uint16_t *>(dest), totalIndices));
+    } else {
+        writeIndices(span(reinterpret_cast<uint32_t *>(dest), totalIndices));
     }
 
-    LOG_S(INFO) << "wrote " << idx << " indices to buffer";
+    byteOffset = (elementOffset + totalIndices) * indexSize;
+    return Slice {
+        .elementOffset = elementOffset,
+        .numElements = totalIndices
+    };
+}
+
+IndexBufferBinding ModelBufferSlices::getIndexBinding(const UntypedBuffer &indexBuffer) const {
+    return IndexBufferBinding(indexBuffer, indexFormat, indices.numElements, indices.elementOffset * indexFormatGetBytes(indexFormat));
 }
 
 glm::vec3 ModelVertex::readTangent() {
@@ -10,14 +10,23 @@
 
 #include <glm/glm.hpp>
 #include <span>
+#include <vector>
+#include <limits>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include "../parallel.h"
+#include "../culling.h"
+
 struct ModelBufferSlices {
     Slice vertices;
+    // counted in elements of `indexFormat`
     Slice indices;
+    IndexFormat indexFormat = IndexFormat::UINT32;
     optional<Slice> instances;
+
+    IndexBufferBinding getIndexBinding(const UntypedBuffer& indexBuffer) const;
 };
 
 struct ModelVertex {
@@ -31,15 +40,86 @@ struct ModelVertex {
     glm::vec3 readTangent();
 };
 
+// below this many vertices it isn't worth handing the conversion to another thread
+const size_t VERTEX_CONVERSION_GRAIN = 16384;
+
+// the batched vertex path copies a whole attribute array of one mesh into the
+// interleaved destination. these loops are kept free of branches and aliasing so
+// the compiler can vectorize them.
+template<typename T, typename M>
+void copyVec3Attribute(const aiVector3D* __restrict source, T* __restrict dest, M T::* member, size_t count) {
+    for(size_t k = 0; k < count; k++) {
+        dest[k].*member = glm::vec3(source[k].x, source[k].y, source[k].z);
+    }
+}
+
+template<typename T, typename M>
+void copyVec2Attribute(const aiVector3D* __restrict source, T* __restrict dest, M T::* member, size_t count) {
+    for(size_t k = 0; k < count; k++) {
+        dest[k].*member = glm::vec2(source[k].x, source[k].y);
+    }
+}
+
+template<typename T, typename M>
+void fillAttribute(T* __restrict dest, M T::* member, M value, size_t count) {
+    for(size_t k = 0; k < count; k++) {
+        dest[k].*member = value;
+    }
+}
+
+struct RequiredAttributes {
+    bool normals;
+    bool tangents;
+    bool textureCoordinates;
+};
+
 class Model {
     Assimp::Importer importer;
     const aiScene* scene;
     size_t totalIndices;
     size_t totalVertices;
-
-    IndexFormat getPreferredIndexFormat();
+    // index of the first vertex of each mesh, as laid out by `writeVertices`
+    std::vector<size_t> meshVertexOffsets;
+    // in the model's local space
+    std::vector<BoundingBox> meshBounds;
+    BoundingBox bounds;
+
+    // logs (once per mesh, rather than once per vertex) any attribute the destination wants but the mesh lacks
+    void checkAttributes(RequiredAttributes required);
+
+    template<typename T>
+    void convertMeshRange(const aiMesh* mesh, T* dest, size_t begin, size_t end) {
+        size_t count = end - begin;
+        dest += begin;
+
+        if constexpr (requires(T v) { v.position; }) {
+            copyVec3Attribute(mesh->mVertices + begin, dest, &T::position, count);
+        }
+        if constexpr (requires(T v) { v.normal; }) {
+            if(mesh->mNormals != nullptr) {
+                copyVec3Attribute(mesh->mNormals + begin, dest, &T::normal, count);
+            } else {
+                fillAttribute(dest, &T::normal, decltype(T::normal)(glm::vec3(0.0f)), count);
+            }
+        }
+        if constexpr (requires(T v) { v.tangent; }) {
+            if(mesh->mTangents != nullptr) {
+                copyVec3Attribute(mesh->mTangents + begin, dest, &T::tangent, count);
+            } else {
+                fillAttribute(dest, &T::tangent, decltype(T::tangent)(glm::vec3(0.0f)), count);
+            }
+        }
+        if constexpr (requires(T v) { v.texCoord; }) {
+            if(mesh->mNumUVComponents[0] >= 1) {
+                copyVec2Attribute(mesh->mTextureCoords[0] + begin, dest, &T::texCoord, count);
+            } else {
+                fillAttribute(dest, &T::texCoord, decltype(T::texCoord)(glm::vec2(0.0f)), count);
+            }
+        }
+    }
 
 public:
+    // `filepath` is relative to the asset root, see `AssetFileSystem`
     Model(const char* filepath);
 
     ~Model() {
@@ -47,10 +127,78 @@ public:
     }
 
     size_t getNumIndices();
+    const BoundingBox& getBounds() const;
+    const BoundingBox& getMeshBounds(size_t mesh) const;
     size_t getNumVertices();
 
-    void writeIndices(span<uint32_t> thisBuffer);
+    // 16-bit whenever every index (relative to the model's first vertex) fits
+    IndexFormat getPreferredIndexFormat();
+    // bytes needed to store all indices in the preferred format
+    size_t getIndexBufferSize();
+
+    // indices are written relative to the first vertex of the whole model,
+    // so draw with the model's vertex offset as the base vertex.
+    template<typename I>
+    void writeIndices(span<I> thisBuffer) {
+        assert(thisBuffer.size() >= totalIndices);
+        assert(totalVertices == 0 || totalVertices - 1 <= std::numeric_limits<I>::max());
+
+        size_t idx = 0;
+        for (size_t i = 0; i < scene->mNumMeshes; i++) {
+            aiMesh *mesh = scene->mMeshes[i];
+            size_t baseVertex = meshVertexOffsets[i];
+
+            for (size_t k = 0; k < mesh->mNumFaces; k++) {
+                const aiFace& face = mesh->mFaces[k];
+
+                for (size_t j = 0; j < face.mNumIndices; j++) {
+                    thisBuffer[idx++] = static_cast<I>(baseVertex + face.mIndices[j]);
+                }
+            }
+        }
+
+        LOG_S(INFO) << "wrote " << idx << " indices to buffer (" << sizeof(I) * 8 << "-bit)";
+    }
+
+    // writes indices in the preferred format into a buffer which may hold indices of both formats,
+    // starting at `byteOffset` (rounded up to the index size). advances `byteOffset` past the written indices
+    // and returns the written range, counted in elements of `getPreferredIndexFormat()`.
+    Slice writeIndices(span<uint8_t> buffer, size_t& byteOffset);
+
+    // fast path for vertex structs whose members are named `position`, `normal`, `tangent` and `texCoord`.
+    // converts whole attribute arrays at a time, with ranges of vertices (across mesh boundaries) split between threads,
+    // writing straight into `buffer` (which may be a mapped GL buffer).
+    template<typename T>
+    void writeVertices(span<T> buffer) {
+        assert(buffer.size() >= totalVertices);
+
+        checkAttributes({
+            .normals = requires(T v) { v.normal; },
+            .tangents = requires(T v) { v.tangent; },
+            .textureCoordinates = requires(T v) { v.texCoord; }
+        });
+
+        T* dest = buffer.data();
+        parallelForRanges(totalVertices, VERTEX_CONVERSION_GRAIN, [this, dest](size_t begin, size_t end) {
+            // find the first mesh overlapping this range, then walk forwards
+            size_t i = std::upper_bound(meshVertexOffsets.begin(), meshVertexOffsets.end(), begin) - meshVertexOffsets.begin() - 1;
+            for(; i < scene->mNumMeshes && meshVertexOffsets[i] < end; i++) {
+                const aiMesh *mesh = scene->mMeshes[i];
+                size_t meshStart = meshVertexOffsets[i];
+                size_t localBegin = std::max(begin, meshStart) - meshStart;
+                size_t localEnd = std::min<size_t>(end - meshStart, mesh->mNumVertices);
+                if(localBegin >= localEnd) {
+                    continue;
+                }
+
+                convertMeshRange(mesh, dest + meshStart, localBegin, localEnd);
+            }
+        });
+
+        LOG_S(INFO) << "wrote " << totalVertices << " vertices to buffer";
+    }
 
+    // slow path, calls `callback` once per vertex. use for custom layouts which can't be expressed by the fast path.
     template<typename T, typename F>
     void writeVertices(span<T> buffer, F callback) {
         int idx = 0;
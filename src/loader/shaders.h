@@ -7,4 +7,6 @@
 #include "../graphics/OpenGLContext.h"
 
 class ShaderCache : public ResourceCache<string, Shader> {
+public:
+    using ResourceCache::ResourceCache;
 };
\ No newline at end of file
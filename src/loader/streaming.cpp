@@ -0,0 +1,184 @@
+#include "streaming.h"
+
+#include <cmath>
+#include <algorithm>
+
+#define LOGURU_WITH_STREAMS 1
+#include <loguru/loguru.hpp>
+
+float computeDesiredMipLevel(uint32_t textureSize, float worldSize, float distance, float projectionScale, uint32_t screenHeight) {
+    float pixelsPerWorldUnit = screenHeight * 0.5f * projectionScale / max(distance, 0.0001f);
+    float texelsPerWorldUnit = textureSize / worldSize;
+    return log2(texelsPerWorldUnit / pixelsPerWorldUnit);
+}
+
+static const void* getLevelData(const DecodedTexture& decoded, uint32_t level) {
+    if(auto cooked = get_if<CookedTexture>(&decoded)) {
+        return cooked->getLevelData(level);
+    }
+    auto& image = get<DecodedImage>(decoded);
+    return level == 0 ? image.pixels.get() : image.mipLevels[level - 1].pixels.data();
+}
+
+TextureStreamer::TextureStreamer(OpenGLContext &context, size_t budgetBytes, size_t uploadBytesPerFrame)
+    : context(context), budgetBytes(budgetBytes), uploadBytesPerFrame(uploadBytesPerFrame) {}
+
+shared_ptr<Texture2d> TextureStreamer::upload(DecodedTexture decoded) {
+    DataFormat format;
+    Dimensions2d size(0, 0);
+    vector<size_t> levelBytes;
+    if(auto cooked = get_if<CookedTexture>(&decoded)) {
+        format = getCookedDataFormat(cooked->format);
+        size = Dimensions2d(cooked->width, cooked->height);
+        for(auto& level : cooked->levels) {
+            levelBytes.push_back(level.byteSize);
+        }
+    } else {
+        auto& image = get<DecodedImage>(decoded);
+        format = getImageFormats(image.numComponents).first;
+        size = image.size;
+        // drivers pad 3 channel formats to 4 bytes per texel
+        size_t bytesPerTexel = image.numComponents == 3 ? 4 : image.numComponents;
+        levelBytes.push_back(size_t(size.width) * size.height * bytesPerTexel);
+        for(auto& level : image.mipLevels) {
+            levelBytes.push_back(size_t(level.width) * level.height * bytesPerTexel);
+        }
+    }
+
+    uint32_t numLevels = levelBytes.size();
+    assert(numLevels == floor(log2(max(size.width, size.height))) + 1);
+
+    uint32_t tailLevel = numLevels - 1;
+    while(tailLevel > 0 && max(size.width, size.height) >> (tailLevel - 1) <= ALWAYS_RESIDENT_SIZE) {
+        tailLevel--;
+    }
+
+    auto streamed = make_unique<StreamedTexture>(StreamedTexture {
+        .texture = make_shared<Texture2d>(context.buildStreamedTexture2D(format, size)),
+        .source = std::move(decoded),
+        .levelBytes = std::move(levelBytes),
+        .residentLevel = numLevels,
+        .tailLevel = tailLevel
+    });
+    for(uint32_t level = numLevels; level-- > tailLevel; ) {
+        makeResident(*streamed, level);
+    }
+
+    shared_ptr<Texture2d> texture = streamed->texture;
+    textures[texture.get()] = std::move(streamed);
+    return texture;
+}
+
+void TextureStreamer::makeResident(StreamedTexture &texture, uint32_t level) {
+    assert(level + 1 == texture.residentLevel);
+    const void *data = getLevelData(texture.source, level);
+    if(holds_alternative<CookedTexture>(texture.source)) {
+        context.allocateCompressedLevel(*texture.texture, level, data, texture.levelBytes[level]);
+    } else {
+        TransferFormat transferFormat = getImageFormats(get<DecodedImage>(texture.source).numComponents).second;
+        context.allocateLevel(*texture.texture, level, transferFormat, data);
+    }
+
+    texture.residentLevel = level;
+    context.setResidentLevels(*texture.texture, level);
+    residentBytes += texture.levelBytes[level];
+}
+
+void TextureStreamer::evict(StreamedTexture &texture) {
+    assert(texture.residentLevel < texture.tailLevel);
+    uint32_t level = texture.residentLevel++;
+    // stop sampling the level before freeing it
+    context.setResidentLevels(*texture.texture, texture.residentLevel);
+    context.releaseLevel(*texture.texture, level);
+    residentBytes -= texture.levelBytes[level];
+}
+
+bool TextureStreamer::makeRoom(size_t bytes, const StreamedTexture &except) {
+    if(residentBytes + bytes <= budgetBytes) {
+        return true;
+    }
+
+    // least recently used first, never evicting levels which were requested this frame
+    vector<StreamedTexture*> candidates;
+    for(auto& [key, texture] : textures) {
+        bool unused = texture->lastUsedFrame < frame;
+        if(texture.get() != &except && texture->residentLevel < texture->tailLevel &&
+           (unused || texture->residentLevel < texture->requestedLevel)) {
+            candidates.push_back(texture.get());
+        }
+    }
+    sort(candidates.begin(), candidates.end(), [](auto a, auto b) { return a->lastUsedFrame < b->lastUsedFrame; });
+
+    for(StreamedTexture* texture : candidates) {
+        uint32_t keepLevel = texture->lastUsedFrame < frame ? texture->tailLevel : texture->requestedLevel;
+        while(texture->residentLevel < keepLevel && residentBytes + bytes > budgetBytes) {
+            evict(*texture);
+        }
+        if(residentBytes + bytes <= budgetBytes) {
+            return true;
+        }
+    }
+    return false;
+}
+
+AssetFuture<Texture2d> TextureStreamer::load(AsyncLoader &loader, Texture2dMetadata metadata) {
+    return loader.runThenUpload(
+        [metadata]() { return metadata.decode(); },
+        [this](DecodedTexture decoded) { return upload(std::move(decoded)); });
+}
+
+void TextureStreamer::request(const Texture2d &texture, float mipLevel) {
+    auto it = textures.find(&texture);
+    if(it == textures.end()) {
+        return;
+    }
+    StreamedTexture& streamed = *it->second;
+
+    uint32_t level = min<uint32_t>(floor(max(mipLevel, 0.0f)), streamed.tailLevel);
+    if(streamed.lastUsedFrame != frame) {
+        streamed.requestedLevel = level;
+        streamed.lastUsedFrame = frame;
+    } else {
+        streamed.requestedLevel = min(streamed.requestedLevel, level);
+    }
+}
+
+void TextureStreamer::update() {
+    vector<StreamedTexture*> wanted;
+    for(auto& [key, texture] : textures) {
+        if(texture->lastUsedFrame == frame && texture->requestedLevel < texture->residentLevel) {
+            wanted.push_back(texture.get());
+        }
+    }
+    // the textures which are furthest from what's on screen go first
+    sort(wanted.begin(), wanted.end(), [](auto a, auto b) {
+        return a->residentLevel - a->requestedLevel > b->residentLevel - b->requestedLevel;
+    });
+
+    size_t uploadedBytes = 0;
+    for(StreamedTexture* texture : wanted) {
+        while(texture->residentLevel > texture->requestedLevel) {
+            size_t bytes = texture->levelBytes[texture->residentLevel - 1];
+            // always allow one level per frame, even if it's bigger than the per frame limit
+            if(uploadedBytes > 0 && uploadedBytes + bytes > uploadBytesPerFrame) {
+                frame++;
+                return;
+            }
+            if(!makeRoom(bytes, *texture)) {
+                break;
+            }
+            makeResident(*texture, texture->residentLevel - 1);
+            uploadedBytes += bytes;
+        }
+    }
+
+    frame++;
+}
+
+size_t TextureStreamer::getResidentBytes() const {
+    return residentBytes;
+}
+
+size_t TextureStreamer::getBudgetBytes() const {
+    return budgetBytes;
+}
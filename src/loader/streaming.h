@@ -0,0 +1,74 @@
+#ifndef GAME_ENGINE_STREAMING_H
+#define GAME_ENGINE_STREAMING_H
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <limits>
+#include "../graphics/texturing.h"
+#include "../graphics/OpenGLContext.h"
+#include "texture.h"
+#include "async.h"
+
+using namespace std;
+
+// levels at or below this size are loaded up front and never evicted
+const uint32_t ALWAYS_RESIDENT_SIZE = 64;
+const size_t DEFAULT_STREAMING_UPLOAD_BYTES_PER_FRAME = 8 * 1024 * 1024;
+
+// the mip level at which one texel covers about one pixel on screen.
+// `worldSize` is the distance the texture spans across the surface, `projectionScale` is `projectionMatrix[1][1]`
+float computeDesiredMipLevel(uint32_t textureSize, float worldSize, float distance, float projectionScale, uint32_t screenHeight);
+
+struct StreamedTexture {
+    shared_ptr<Texture2d> texture;
+    // every level, kept in system memory so they can be uploaded again after being evicted
+    DecodedTexture source;
+    vector<size_t> levelBytes;
+    // levels from `residentLevel` up to the 1x1 level are in video memory
+    uint32_t residentLevel;
+    // levels from here up to the 1x1 level are always resident
+    uint32_t tailLevel;
+    // the finest level requested during `lastUsedFrame`
+    uint32_t requestedLevel = numeric_limits<uint32_t>::max();
+    uint64_t lastUsedFrame = 0;
+};
+
+// keeps only the mip levels which are needed on screen in video memory, under a fixed byte budget.
+// textures start with just their small levels resident, finer levels are uploaded (a few per frame)
+// once `request` asks for them, and the least recently used textures lose their finest levels
+// whenever the budget is exceeded.
+class TextureStreamer {
+    OpenGLContext& context;
+    size_t budgetBytes;
+    size_t uploadBytesPerFrame;
+    size_t residentBytes = 0;
+    uint64_t frame = 1;
+    unordered_map<const Texture2d*, unique_ptr<StreamedTexture>> textures;
+
+    shared_ptr<Texture2d> upload(DecodedTexture decoded);
+    void makeResident(StreamedTexture& texture, uint32_t level);
+    void evict(StreamedTexture& texture);
+    // evicts levels from other textures until `bytes` more fit in the budget. returns whether they do
+    bool makeRoom(size_t bytes, const StreamedTexture& except);
+
+public:
+    TextureStreamer(OpenGLContext& context, size_t budgetBytes, size_t uploadBytesPerFrame = DEFAULT_STREAMING_UPLOAD_BYTES_PER_FRAME);
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // decodes every level on a worker thread, but only uploads the always resident ones
+    AssetFuture<Texture2d> load(AsyncLoader& loader, Texture2dMetadata metadata);
+
+    // call each frame for every use of `texture`, e.g.: with `computeDesiredMipLevel`
+    void request(const Texture2d& texture, float mipLevel);
+
+    // must be called on the context thread once per frame, after the requests for that frame
+    void update();
+
+    size_t getResidentBytes() const;
+    size_t getBudgetBytes() const;
+};
+
+#endif //GAME_ENGINE_STREAMING_H
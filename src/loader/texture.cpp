@@ -4,6 +4,7 @@
 #include <algorithm>
 #include "texture.h"
 #include "stb_image.h"
+#include "vfs.h"
 
 Texture2d create1By1Texture(OpenGLContext &context, glm::vec3 color) {
     auto tex = context.buildTexture2D(DataFormat::R8G8B8_UINT, Dimensions2d(1, 1), false);
@@ -23,44 +24,122 @@ Texture2d create1By1NormalMap(OpenGLContext &context, glm::vec3 normal) {
     return std::move(create1By1Texture(context, (normal + glm::vec3(1.0f)) * 0.5f));
 }
 
-shared_ptr<Texture2d> Texture2dMetadata::build(OpenGLContext &context) {
+DataFormat getCookedDataFormat(CookedFormat format) {
+    switch(format) {
+        case CookedFormat::BC1_RGB:
+            return DataFormat::BC1_RGB_UNORM;
+        case CookedFormat::BC3_RGBA:
+            return DataFormat::BC3_RGBA_UNORM;
+        case CookedFormat::BC4_R:
+            return DataFormat::BC4_R_UNORM;
+        case CookedFormat::BC5_RG:
+            return DataFormat::BC5_RG_UNORM;
+        default:
+            assert(false);
+            return DataFormat::BC1_RGB_UNORM;
+    }
+}
+
+DecodedTexture Texture2dMetadata::decode() const {
+    // cooked textures are already in their final format, so `format` doesn't apply
+    unique_ptr<AssetFile> file = getAssetFileSystem().open(path);
+    if(!file) {
+        throw TextureLoadingError("file not found");
+    }
+    if(isCookedTexturePath(path)) {
+        optional<CookedTexture> cooked = readCookedTexture(*file, path);
+        if(!cooked) {
+            throw TextureLoadingError("invalid cooked texture");
+        }
+        LOG_S(INFO) << "loaded cooked texture from " << path << " " << cooked->width << ", " << cooked->height << " (" << cooked->levels.size() << " levels)";
+        return std::move(*cooked);
+    }
+
     int x, y, n;
 
     int numComponents;
-    if(format == DesiredTextureFormat::DONT_CARE) {
-        numComponents = 0;
-    } else if(format == DesiredTextureFormat::ALPHA) {
-        numComponents = 4;
-    } else if(format == DesiredTextureFormat::NO_ALPHA) {
+    if(format == DesiredTextureFormat::MASK) {
+        numComponents = 1;
+    } else if(format == DesiredTextureFormat::NORMAL_MAP) {
         numComponents = 3;
+    } else {
+        // stb fills in an opaque alpha channel
+        numComponents = 4;
     }
 
-    unsigned char *data = stbi_load(path.c_str(), &x, &y, &n, numComponents);
+    vector<uint8_t> encoded(file->getSize());
+    if(!file->read(0, encoded.size(), encoded.data())) {
+        throw TextureLoadingError("couldn't read file");
+    }
+    unsigned char *data = stbi_load_from_memory(encoded.data(), encoded.size(), &x, &y, &n, numComponents);
     if (data == nullptr) {
         throw TextureLoadingError(stbi_failure_reason());
     }
     LOG_S(INFO) << "loaded image from " << path << " " << x << ", " << y << ", " << n;
 
     int actualComponents = numComponents;
-    if(actualComponents == 0) {
-        actualComponents = n;
+    if(format == DesiredTextureFormat::NORMAL_MAP) {
+        // drop Z in place, each texel is written at or before where it was read from
+        for(size_t i = 0; i < size_t(x) * y; i++) {
+            data[i * 2] = data[i * 3];
+            data[i * 2 + 1] = data[i * 3 + 1];
+        }
+        actualComponents = 2;
     }
 
-    DataFormat dformat;
-    TransferFormat tformat;
-    if(actualComponents == 3) {
-        dformat = DataFormat::R8G8B8_UINT;
-        tformat = TransferFormat::R8G8B8_UINT;
-    } else if(actualComponents == 4) {
-        dformat = DataFormat::R8G8B8A8_UINT;
-        tformat = TransferFormat::R8G8B8A8_UINT;
+    DecodedImage image {
+        .pixels = unique_ptr<unsigned char, void (*)(void *)>(data, stbi_image_free),
+        .size = Dimensions2d(x, y),
+        .numComponents = actualComponents
+    };
+    image.mipLevels = generateMipLevels(data, x, y, actualComponents, colorSpace);
+    return image;
+}
+
+pair<DataFormat, TransferFormat> getImageFormats(int numComponents) {
+    if(numComponents == 1) {
+        return { DataFormat::R8_UNORM, TransferFormat::R8_UINT };
+    } else if(numComponents == 2) {
+        return { DataFormat::R8G8_UNORM, TransferFormat::R8G8_UINT };
+    } else if(numComponents == 3) {
+        return { DataFormat::R8G8B8_UINT, TransferFormat::R8G8B8_UINT };
+    } else if(numComponents == 4) {
+        return { DataFormat::R8G8B8A8_UINT, TransferFormat::R8G8B8A8_UINT };
     } else {
-        LOG_S(ERROR) << "unsupported number of components in image: " << actualComponents;
+        LOG_S(ERROR) << "unsupported number of components in image: " << numComponents;
         assert(false);
+        return { DataFormat::R8G8B8A8_UINT, TransferFormat::R8G8B8A8_UINT };
     }
+}
+
+shared_ptr<Texture2d> uploadCooked(OpenGLContext &context, const CookedTexture& cooked) {
+    Dimensions2d size(cooked.width, cooked.height);
+    auto tex = context.buildTexture2D(getCookedDataFormat(cooked.format), size, cooked.levels.size() > 1);
+    assert(cooked.levels.size() == 1 || cooked.levels.size() == floor(log2(max(size.width, size.height))) + 1);
 
-    auto tex = context.buildTexture2D(dformat, Dimensions2d(x, y), true);
-    context.uploadBaseImage2D(tex, tformat, data);
+    for(uint32_t level = 0; level < cooked.levels.size(); level++) {
+        context.uploadCompressedImage2D(tex, level, cooked.getLevelData(level), cooked.levels[level].byteSize);
+    }
 
     return make_shared<Texture2d>(std::move(tex));
 }
+
+shared_ptr<Texture2d> Texture2dMetadata::upload(OpenGLContext &context, DecodedTexture decoded) const {
+    if(auto cooked = get_if<CookedTexture>(&decoded)) {
+        return uploadCooked(context, *cooked);
+    }
+    DecodedImage& image = get<DecodedImage>(decoded);
+
+    auto [dformat, tformat] = getImageFormats(image.numComponents);
+    auto tex = context.buildTexture2D(dformat, image.size, true);
+    context.uploadImage2D(tex, 0, tformat, image.pixels.get());
+    for(uint32_t level = 0; level < image.mipLevels.size(); level++) {
+        context.uploadImage2D(tex, level + 1, tformat, image.mipLevels[level].pixels.data());
+    }
+
+    return make_shared<Texture2d>(std::move(tex));
+}
+
+shared_ptr<Texture2d> Texture2dMetadata::build(OpenGLContext &context) {
+    return upload(context, decode());
+}
@@ -5,18 +5,39 @@
 #include <string>
 #include <memory>
 #include <exception>
+#include <variant>
 #include "../graphics/texturing.h"
 #include "../graphics/OpenGLContext.h"
 #include "cache.h"
+#include "cooked_texture.h"
+#include "mipmaps.h"
 
 using namespace std;
 
+// how the texture is used, which decides how it's stored.
+// colors are always stored as RGBA8, since drivers pad RGB8 to 4 bytes per texel anyway
 enum class DesiredTextureFormat {
     DONT_CARE,
     NO_ALPHA,
-    ALPHA
+    ALPHA,
+    // single channel data (masks, roughness, etc.), stored as R8
+    MASK,
+    // tangent space normals. only X and Y are stored (as RG8), the shader reconstructs Z
+    NORMAL_MAP
 };
 
+// pixels decoded on a loader thread, waiting to be uploaded
+struct DecodedImage {
+    unique_ptr<unsigned char, void (*)(void *)> pixels;
+    Dimensions2d size;
+    int numComponents;
+    // every level below the base image, generated on the loader thread
+    vector<MipLevel> mipLevels;
+};
+
+// either raw pixels, or (for `.ctex` files) mip levels which were compressed by the `texture_cooker`
+using DecodedTexture = variant<DecodedImage, CookedTexture>;
+
 class TextureLoadingError : exception {
 public:
     const char *stbi_reason;
@@ -26,19 +47,29 @@ public:
 };
 
 struct Texture2dMetadata {
+    // relative to the asset root, see `AssetFileSystem`
     string path;
     DesiredTextureFormat format;
+    // how mip levels are filtered. always `LINEAR` for masks and normal maps, which hold data rather than colors
+    ColorSpace colorSpace;
 
-    Texture2dMetadata(string path, DesiredTextureFormat format) : path(path), format(format) {};
+    Texture2dMetadata(string path, DesiredTextureFormat format, ColorSpace colorSpace = ColorSpace::SRGB)
+        : path(path), format(format),
+          colorSpace(format == DesiredTextureFormat::MASK || format == DesiredTextureFormat::NORMAL_MAP ? ColorSpace::LINEAR : colorSpace) {};
 
     Texture2dMetadata getKey() const {
         return *this;
     };
 
+    // safe to call from any thread
+    DecodedTexture decode() const;
+    // must be called on the context thread
+    shared_ptr<Texture2d> upload(OpenGLContext& context, DecodedTexture decoded) const;
+
     shared_ptr<Texture2d> build(OpenGLContext& context);
 
     bool operator==(const Texture2dMetadata& b) const {
-        return path == b.path && format == b.format;
+        return path == b.path && format == b.format && colorSpace == b.colorSpace;
     }
 
 };
@@ -61,16 +92,22 @@ namespace std {
             // and bit shifting:
 
             return ((hash<string>()(k.path)
-                     ^ (hash<DesiredTextureFormat>()(k.format) << 1)) >> 1);
+                     ^ (hash<DesiredTextureFormat>()(k.format) << 1)) >> 1)
+                   ^ (hash<ColorSpace>()(k.colorSpace) << 2);
         }
     };
 
 }
 
 class Texture2dCache : public ResourceCache<Texture2dMetadata, Texture2d> {
-
+public:
+    using ResourceCache::ResourceCache;
 };
 
+DataFormat getCookedDataFormat(CookedFormat format);
+// the texture and transfer formats for images with `numComponents` 8-bit channels
+pair<DataFormat, TransferFormat> getImageFormats(int numComponents);
+
 Texture2d loadTexture(OpenGLContext &context, const char* path, DesiredTextureFormat format);
 Texture2d create1By1Texture(OpenGLContext &context, glm::vec3 color);
 Texture2d create1By1NormalMap(OpenGLContext &context, glm::vec3 normal);
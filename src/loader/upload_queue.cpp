@@ -0,0 +1,176 @@
+#include "upload_queue.h"
+
+#include <cstring>
+#include <cmath>
+
+#define LOGURU_WITH_STREAMS 1
+#include <loguru/loguru.hpp>
+
+// keeps every level's offset a multiple of the largest texel size
+const size_t STAGING_ALIGNMENT = 4;
+
+TextureUploadQueue::TextureUploadQueue(OpenGLContext &context, AsyncLoader &loader, size_t stagingBytes, size_t uploadBytesPerFrame)
+    : context(context), loader(loader), stagingRanges(stagingBytes), uploadBytesPerFrame(uploadBytesPerFrame) {
+    staging = unique_ptr<UntypedBuffer>(context.buildBuffer(BufferUsage::STREAM_DRAW, stagingBytes,
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT).onHeap());
+    stagingMemory = static_cast<uint8_t*>(context.mapPersistentBuffer(*staging));
+}
+
+TextureUploadQueue::~TextureUploadQueue() {
+    for(auto& upload : inFlight) {
+        context.deleteFence(upload.fence);
+    }
+}
+
+StagedTexture TextureUploadQueue::stage(DecodedTexture decoded) {
+    StagedTexture staged;
+    vector<const void*> levels;
+    if(auto cooked = get_if<CookedTexture>(&decoded)) {
+        staged.format = getCookedDataFormat(cooked->format);
+        staged.transferFormat = TransferFormat::R8G8B8A8_UINT;
+        staged.compressed = true;
+        staged.size = Dimensions2d(cooked->width, cooked->height);
+        for(uint32_t level = 0; level < cooked->levels.size(); level++) {
+            staged.levelBytes.push_back(cooked->levels[level].byteSize);
+            levels.push_back(cooked->getLevelData(level));
+        }
+    } else {
+        auto& image = get<DecodedImage>(decoded);
+        tie(staged.format, staged.transferFormat) = getImageFormats(image.numComponents);
+        staged.compressed = false;
+        staged.size = image.size;
+        staged.levelBytes.push_back(size_t(image.size.width) * image.size.height * image.numComponents);
+        levels.push_back(image.pixels.get());
+        for(auto& level : image.mipLevels) {
+            staged.levelBytes.push_back(level.pixels.size());
+            levels.push_back(level.pixels.data());
+        }
+    }
+
+    size_t totalBytes = 0;
+    for(size_t bytes : staged.levelBytes) {
+        totalBytes += (bytes + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+    }
+    {
+        lock_guard lock(stagingMutex);
+        staged.stagingOffset = stagingRanges.allocate(totalBytes, STAGING_ALIGNMENT);
+    }
+
+    if(!staged.stagingOffset) {
+        // uploaded straight from client memory instead, the pointers stay valid when `decoded` is moved
+        staged.levelData = std::move(levels);
+        staged.source = std::move(decoded);
+        return staged;
+    }
+
+    staged.stagingBytes = totalBytes;
+    size_t offset = *staged.stagingOffset;
+    for(size_t level = 0; level < levels.size(); level++) {
+        memcpy(stagingMemory + offset, levels[level], staged.levelBytes[level]);
+        staged.levelData.push_back(reinterpret_cast<const void*>(offset));
+        offset += (staged.levelBytes[level] + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+    }
+    return staged;
+}
+
+void TextureUploadQueue::submit(shared_ptr<PendingUpload> upload) {
+    StagedTexture& staged = upload->staged;
+    uint32_t numLevels = staged.levelBytes.size();
+
+    if(staged.stagingOffset) {
+        context.bindPixelUnpackBuffer(staging.get());
+    }
+    while(upload->nextLevel < numLevels) {
+        uint32_t level = upload->nextLevel;
+        size_t bytes = staged.levelBytes[level];
+        // a single level bigger than the budget still goes through, on a frame of its own
+        if(!ignoreBudget && uploadedThisFrame > 0 && uploadedThisFrame + bytes > uploadBytesPerFrame) {
+            break;
+        }
+
+        if(staged.compressed) {
+            context.uploadCompressedImage2D(*upload->texture, level, staged.levelData[level], bytes);
+        } else {
+            context.uploadImage2D(*upload->texture, level, staged.transferFormat, staged.levelData[level]);
+        }
+        uploadedThisFrame += bytes;
+        upload->nextLevel++;
+    }
+    if(staged.stagingOffset) {
+        context.bindPixelUnpackBuffer(nullptr);
+    }
+
+    if(upload->nextLevel < numLevels) {
+        loader.runOnContextThread([this, upload]() { submit(upload); });
+        return;
+    }
+
+    if(staged.stagingOffset) {
+        inFlight.push_back(InFlightUpload {
+            .fence = context.insertFence(),
+            .stagingOffset = *staged.stagingOffset,
+            .stagingBytes = staged.stagingBytes
+        });
+    }
+    upload->done.set_value(upload->texture);
+}
+
+void TextureUploadQueue::retireFinishedUploads() {
+    while(!inFlight.empty() && context.hasFenceSignalled(inFlight.front().fence)) {
+        InFlightUpload& upload = inFlight.front();
+        context.deleteFence(upload.fence);
+        {
+            lock_guard lock(stagingMutex);
+            stagingRanges.free(upload.stagingOffset, upload.stagingBytes);
+        }
+        inFlight.pop_front();
+    }
+}
+
+AssetFuture<Texture2d> TextureUploadQueue::load(Texture2dMetadata metadata) {
+    auto upload = make_shared<PendingUpload>();
+    AssetFuture<Texture2d> future = upload->done.get_future().share();
+
+    loader.runThenUpload(
+        [this, metadata, upload]() -> shared_ptr<PendingUpload> {
+            try {
+                upload->staged = stage(metadata.decode());
+                return upload;
+            } catch(...) {
+                upload->done.set_exception(current_exception());
+                return nullptr;
+            }
+        },
+        [this](shared_ptr<PendingUpload> upload) {
+            if(upload == nullptr) {
+                return;
+            }
+            StagedTexture& staged = upload->staged;
+            upload->texture = make_shared<Texture2d>(context.buildTexture2D(staged.format, staged.size, staged.levelBytes.size() > 1));
+            submit(upload);
+        });
+
+    return future;
+}
+
+void TextureUploadQueue::update() {
+    uploadedThisFrame = 0;
+    retireFinishedUploads();
+}
+
+shared_ptr<Texture2d> TextureUploadQueue::wait(const AssetFuture<Texture2d> &future) {
+    ignoreBudget = true;
+    try {
+        shared_ptr<Texture2d> texture = loader.wait(future);
+        ignoreBudget = false;
+        return texture;
+    } catch(...) {
+        ignoreBudget = false;
+        throw;
+    }
+}
+
+size_t TextureUploadQueue::getStagingBytesInUse() {
+    lock_guard lock(stagingMutex);
+    return stagingRanges.getNumAllocated();
+}
@@ -0,0 +1,95 @@
+#ifndef GAME_ENGINE_UPLOAD_QUEUE_H
+#define GAME_ENGINE_UPLOAD_QUEUE_H
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include "../graphics/texturing.h"
+#include "../graphics/OpenGLContext.h"
+#include "../graphics/GeometryPool.h"
+#include "texture.h"
+#include "async.h"
+
+using namespace std;
+
+const size_t DEFAULT_UPLOAD_STAGING_BYTES = 64 * 1024 * 1024;
+const size_t DEFAULT_UPLOAD_BYTES_PER_FRAME = 16 * 1024 * 1024;
+
+// every mip level of a decoded texture, ready to be handed to GL
+struct StagedTexture {
+    DataFormat format;
+    TransferFormat transferFormat;
+    bool compressed;
+    Dimensions2d size = Dimensions2d(0, 0);
+    vector<size_t> levelBytes;
+    // byte offsets into the staging buffer, or pointers into `source` if it didn't fit
+    vector<const void*> levelData;
+    optional<size_t> stagingOffset;
+    size_t stagingBytes = 0;
+    // only kept if the levels couldn't be copied into the staging buffer
+    optional<DecodedTexture> source;
+};
+
+// uploads textures through a persistently mapped pixel unpack buffer.
+// loader threads copy the decoded levels straight into the mapped buffer, so the context thread only
+// issues `glTexSubImage2D` calls, which the driver can run asynchronously. at most `uploadBytesPerFrame`
+// are uploaded each frame, bigger textures are spread over several frames. a fence is placed after
+// each texture's last level, and its part of the staging buffer is reused once the fence is signalled.
+class TextureUploadQueue {
+    struct PendingUpload {
+        StagedTexture staged;
+        shared_ptr<Texture2d> texture;
+        uint32_t nextLevel = 0;
+        promise<shared_ptr<Texture2d>> done;
+    };
+
+    struct InFlightUpload {
+        GLsync fence;
+        size_t stagingOffset;
+        size_t stagingBytes;
+    };
+
+    OpenGLContext& context;
+    AsyncLoader& loader;
+    unique_ptr<UntypedBuffer> staging;
+    uint8_t* stagingMemory;
+    // shared with the loader threads
+    mutex stagingMutex;
+    RangeAllocator stagingRanges;
+    // in the order they were submitted, which is the order their fences are signalled in
+    deque<InFlightUpload> inFlight;
+
+    size_t uploadBytesPerFrame;
+    size_t uploadedThisFrame = 0;
+    // set while the context thread is blocked on a texture anyway
+    bool ignoreBudget = false;
+
+    // runs on a loader thread
+    StagedTexture stage(DecodedTexture decoded);
+    // uploads levels until the frame's budget runs out, then carries on during the next frame
+    void submit(shared_ptr<PendingUpload> upload);
+    void retireFinishedUploads();
+
+public:
+    TextureUploadQueue(OpenGLContext& context, AsyncLoader& loader, size_t stagingBytes = DEFAULT_UPLOAD_STAGING_BYTES,
+                       size_t uploadBytesPerFrame = DEFAULT_UPLOAD_BYTES_PER_FRAME);
+    ~TextureUploadQueue();
+
+    TextureUploadQueue(const TextureUploadQueue&) = delete;
+    TextureUploadQueue& operator=(const TextureUploadQueue&) = delete;
+
+    // the future is ready once every level has been uploaded
+    AssetFuture<Texture2d> load(Texture2dMetadata metadata);
+
+    // must be called on the context thread once per frame, before `AsyncLoader::processUploads`
+    void update();
+
+    // like `AsyncLoader::wait`, but doesn't hold back uploads to stay within the per frame budget
+    shared_ptr<Texture2d> wait(const AssetFuture<Texture2d>& future);
+
+    size_t getStagingBytesInUse();
+};
+
+#endif //GAME_ENGINE_UPLOAD_QUEUE_H
@@ -0,0 +1,108 @@
+#include "vfs.h"
+
+#include <fstream>
+
+#define LOGURU_WITH_STREAMS 1
+#include <loguru/loguru.hpp>
+
+class LooseFile : public AssetFile {
+    ifstream file;
+    size_t size;
+public:
+    LooseFile(ifstream&& file, size_t size) : file(std::move(file)), size(size) {}
+
+    virtual size_t getSize() const {
+        return size;
+    }
+
+    virtual bool read(size_t offset, size_t bytes, void* out) {
+        if(offset + bytes > size) {
+            return false;
+        }
+        file.seekg(offset);
+        return bool(file.read(static_cast<char*>(out), bytes));
+    }
+};
+
+class PackedFile : public AssetFile {
+    const AssetArchive& archive;
+    const AssetArchiveEntry& entry;
+    ArchiveBlockCache cache;
+public:
+    PackedFile(const AssetArchive& archive, const AssetArchiveEntry& entry) : archive(archive), entry(entry) {}
+
+    virtual size_t getSize() const {
+        return entry.size;
+    }
+
+    virtual bool read(size_t offset, size_t bytes, void* out) {
+        return archive.read(entry, offset, bytes, static_cast<uint8_t*>(out), cache);
+    }
+};
+
+void AssetFileSystem::mountDirectory(string directory, string prefix) {
+    if(!directory.empty() && directory.back() != '/') {
+        directory += '/';
+    }
+    mounts.push_back(Mount {
+        .directory = std::move(directory),
+        .prefix = std::move(prefix),
+        .archive = nullptr
+    });
+}
+
+bool AssetFileSystem::mountArchive(const string &path) {
+    unique_ptr<AssetArchive> archive = AssetArchive::open(path);
+    if(!archive) {
+        return false;
+    }
+    mounts.push_back(Mount {
+        .directory = "",
+        .prefix = "",
+        .archive = std::move(archive)
+    });
+    return true;
+}
+
+unique_ptr<AssetFile> AssetFileSystem::open(const string &path) const {
+    for(auto mount = mounts.rbegin(); mount != mounts.rend(); mount++) {
+        if(mount->archive) {
+            if(const AssetArchiveEntry* entry = mount->archive->find(path)) {
+                return make_unique<PackedFile>(*mount->archive, *entry);
+            }
+            continue;
+        }
+        if(path.compare(0, mount->prefix.size(), mount->prefix) != 0) {
+            continue;
+        }
+        ifstream file(mount->directory + path.substr(mount->prefix.size()), ios::binary | ios::ate);
+        if(file) {
+            size_t size = file.tellg();
+            return make_unique<LooseFile>(std::move(file), size);
+        }
+    }
+    return nullptr;
+}
+
+bool AssetFileSystem::exists(const string &path) const {
+    return open(path) != nullptr;
+}
+
+optional<vector<uint8_t>> AssetFileSystem::readAll(const string &path) const {
+    unique_ptr<AssetFile> file = open(path);
+    if(!file) {
+        LOG_S(ERROR) << "couldn't find asset " << path;
+        return nullopt;
+    }
+    vector<uint8_t> data(file->getSize());
+    if(!file->read(0, data.size(), data.data())) {
+        LOG_S(ERROR) << "couldn't read asset " << path;
+        return nullopt;
+    }
+    return data;
+}
+
+AssetFileSystem &getAssetFileSystem() {
+    static AssetFileSystem fileSystem;
+    return fileSystem;
+}
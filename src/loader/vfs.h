@@ -0,0 +1,51 @@
+#ifndef GAME_ENGINE_VFS_H
+#define GAME_ENGINE_VFS_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <optional>
+#include "archive.h"
+
+using namespace std;
+
+// a file opened through the `AssetFileSystem`, either loose on disk or inside an archive.
+// each thread should open its own
+class AssetFile {
+public:
+    virtual ~AssetFile() = default;
+
+    virtual size_t getSize() const = 0;
+    // copies `size` bytes starting at `offset` into `out`, e.g.: straight into a staging buffer
+    virtual bool read(size_t offset, size_t size, void* out) = 0;
+};
+
+// resolves asset paths (relative to the asset root, e.g.: "textures/foo.png") against the mounted
+// archives and directories, the most recently mounted first.
+// mount everything before loading starts, lookups are then safe from any thread
+class AssetFileSystem {
+    struct Mount {
+        // loose files if `archive` is null
+        string directory;
+        string prefix;
+        unique_ptr<AssetArchive> archive;
+    };
+
+    vector<Mount> mounts;
+
+public:
+    // files in `directory` are found under `prefix`, e.g.: "cooked/"
+    void mountDirectory(string directory, string prefix = "");
+    // returns false (and logs why) if `path` isn't a valid archive
+    bool mountArchive(const string& path);
+
+    // `nullptr` if no mount has the file
+    unique_ptr<AssetFile> open(const string& path) const;
+    bool exists(const string& path) const;
+    optional<vector<uint8_t>> readAll(const string& path) const;
+};
+
+// the one every loader goes through
+AssetFileSystem& getAssetFileSystem();
+
+#endif //GAME_ENGINE_VFS_H
@@ -0,0 +1,283 @@
+#include "virtual_texture.h"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#define LOGURU_WITH_STREAMS 1
+#include <loguru/loguru.hpp>
+
+const size_t PAGE_BYTES = size_t(VIRTUAL_PAGE_SLOT_SIZE) * VIRTUAL_PAGE_SLOT_SIZE * 4;
+
+PageSource imagePageSource(shared_ptr<const DecodedImage> image) {
+    assert(image->numComponents == 4);
+    assert(image->size.width == image->size.height && has_single_bit(image->size.width / VIRTUAL_PAGE_SIZE));
+
+    return [image](uint32_t level, uint32_t x, uint32_t y, uint8_t* out) {
+        const uint8_t* pixels = level == 0 ? image->pixels.get() : image->mipLevels[level - 1].pixels.data();
+        int32_t size = max(1u, image->size.width >> level);
+
+        int32_t originX = int32_t(x * VIRTUAL_PAGE_SIZE) - int32_t(VIRTUAL_PAGE_BORDER);
+        int32_t originY = int32_t(y * VIRTUAL_PAGE_SIZE) - int32_t(VIRTUAL_PAGE_BORDER);
+        for(int32_t row = 0; row < int32_t(VIRTUAL_PAGE_SLOT_SIZE); row++) {
+            int32_t sourceY = ((originY + row) % size + size) % size;
+            for(int32_t column = 0; column < int32_t(VIRTUAL_PAGE_SLOT_SIZE); column++) {
+                int32_t sourceX = ((originX + column) % size + size) % size;
+                memcpy(out, pixels + (size_t(sourceY) * size + sourceX) * 4, 4);
+                out += 4;
+            }
+        }
+    };
+}
+
+VirtualTexture::VirtualTexture(OpenGLContext &context, AsyncLoader &loader, PageSource source, uint8_t id, uint32_t virtualPages,
+                               uint32_t physicalPages, uint32_t maxPendingLoads)
+    : context(context), loader(loader), source(std::move(source)), id(id), virtualPages(virtualPages),
+      maxLevel(countr_zero(virtualPages)), physicalPages(physicalPages), maxPendingLoads(maxPendingLoads),
+      physicalCache(context.buildTexture2D(DataFormat::R8G8B8A8_SRGB,
+          Dimensions2d(physicalPages * VIRTUAL_PAGE_SLOT_SIZE, physicalPages * VIRTUAL_PAGE_SLOT_SIZE), false)),
+      pageTable(context.buildTexture2D(DataFormat::R8G8B8A8_UINT, Dimensions2d(virtualPages, virtualPages), true)) {
+    assert(has_single_bit(virtualPages) && virtualPages <= MAX_VIRTUAL_PAGES);
+    assert(physicalPages > 1 && physicalPages <= 256);
+    assert(id != NO_VIRTUAL_TEXTURE);
+
+    slots.resize(physicalPages * physicalPages);
+
+    // loaded up front, so there's always something to fall back to
+    vector<uint8_t> texels(PAGE_BYTES);
+    this->source(maxLevel, 0, 0, texels.data());
+    slots[0].pinned = true;
+    storePage(pageKey(maxLevel, 0, 0), 0, texels);
+    uploadPageTable();
+}
+
+void VirtualTexture::request(uint32_t level, uint32_t x, uint32_t y) {
+    if(level > maxLevel || x >= virtualPages >> level || y >= virtualPages >> level) {
+        return;
+    }
+    // the ancestors are needed too, so the page table has something to fall back to while the page loads
+    for(; level <= maxLevel; level++, x /= 2, y /= 2) {
+        uint32_t page = pageKey(level, x, y);
+        if(!requestedPages.insert(page).second) {
+            // so were its ancestors
+            return;
+        }
+        auto resident = residentPages.find(page);
+        if(resident != residentPages.end()) {
+            slots[resident->second].lastUsedFrame = frame;
+        }
+    }
+}
+
+void VirtualTexture::update() {
+    vector<uint32_t> missing;
+    for(uint32_t page : requestedPages) {
+        if(!residentPages.contains(page) && !loadingPages.contains(page)) {
+            missing.push_back(page);
+        }
+    }
+    // the level is in the top bits, so coarse pages (which finer ones fall back to) load first
+    sort(missing.begin(), missing.end(), greater<uint32_t>());
+    for(uint32_t page : missing) {
+        if(loadingPages.size() >= maxPendingLoads) {
+            break;
+        }
+        startLoad(page);
+    }
+
+    if(pageTableDirty) {
+        uploadPageTable();
+    }
+    requestedPages.clear();
+    frame++;
+}
+
+void VirtualTexture::startLoad(uint32_t page) {
+    loadingPages.insert(page);
+    weak_ptr<bool> alive = this->alive;
+    loader.runThenUpload(
+        [source = source, page]() {
+            vector<uint8_t> texels(PAGE_BYTES);
+            try {
+                source(page >> 16, page & 0xff, (page >> 8) & 0xff, texels.data());
+            } catch(const exception& e) {
+                LOG_S(WARNING) << "failed to load virtual texture page: " << e.what();
+                texels.clear();
+            }
+            return texels;
+        },
+        [this, alive, page](vector<uint8_t> texels) {
+            if(alive.expired()) {
+                return;
+            }
+            pageLoaded(page, texels);
+        });
+}
+
+void VirtualTexture::pageLoaded(uint32_t page, const vector<uint8_t> &texels) {
+    loadingPages.erase(page);
+    if(texels.empty()) {
+        return;
+    }
+    optional<uint32_t> slot = findFreeSlot();
+    if(!slot) {
+        // everything in the cache is on screen, the page is requested again once something goes off screen
+        return;
+    }
+    storePage(page, *slot, texels);
+}
+
+optional<uint32_t> VirtualTexture::findFreeSlot() {
+    optional<uint32_t> leastRecentlyUsed;
+    for(uint32_t index = 0; index < slots.size(); index++) {
+        Slot& slot = slots[index];
+        if(slot.pinned) {
+            continue;
+        }
+        if(!slot.page) {
+            return index;
+        }
+        // loads finish after `update`, so pages used during the previous frame are still on screen
+        if(slot.lastUsedFrame + 1 < frame && (!leastRecentlyUsed || slot.lastUsedFrame < slots[*leastRecentlyUsed].lastUsedFrame)) {
+            leastRecentlyUsed = index;
+        }
+    }
+    return leastRecentlyUsed;
+}
+
+void VirtualTexture::storePage(uint32_t page, uint32_t index, const vector<uint8_t> &texels) {
+    Slot& slot = slots[index];
+    bool evicted = slot.page.has_value();
+    if(evicted) {
+        residentPages.erase(*slot.page);
+    }
+    slot.page = page;
+    slot.lastUsedFrame = frame;
+    residentPages[page] = index;
+
+    Rect2d region(Point2d(index % physicalPages * VIRTUAL_PAGE_SLOT_SIZE, index / physicalPages * VIRTUAL_PAGE_SLOT_SIZE),
+                  Dimensions2d(VIRTUAL_PAGE_SLOT_SIZE, VIRTUAL_PAGE_SLOT_SIZE));
+    context.uploadRegion2D(physicalCache, 0, region, TransferFormat::R8G8B8A8_UINT, texels.data());
+    if(evicted) {
+        // loads finish between `update`s, so waiting for the next one would let the evicted page's entries
+        // sample the new texels in the meantime. an empty slot isn't referenced by anything yet
+        uploadPageTable();
+    } else {
+        pageTableDirty = true;
+    }
+}
+
+void VirtualTexture::uploadPageTable() {
+    // each entry holds the x and y of a slot and the level of the page in it.
+    // pages which aren't resident copy their parent's entry, the coarsest page always is
+    vector<uint8_t> parent;
+    vector<uint8_t> current;
+    for(uint32_t level = maxLevel + 1; level-- > 0; ) {
+        uint32_t pages = virtualPages >> level;
+        current.assign(size_t(pages) * pages * 4, 0);
+        for(uint32_t y = 0; y < pages; y++) {
+            for(uint32_t x = 0; x < pages; x++) {
+                uint8_t* entry = &current[(size_t(y) * pages + x) * 4];
+                auto resident = residentPages.find(pageKey(level, x, y));
+                if(resident != residentPages.end()) {
+                    entry[0] = resident->second % physicalPages;
+                    entry[1] = resident->second / physicalPages;
+                    entry[2] = level;
+                    entry[3] = 255;
+                } else {
+                    assert(level < maxLevel);
+                    memcpy(entry, &parent[(size_t(y / 2) * (pages / 2) + x / 2) * 4], 4);
+                }
+            }
+        }
+        context.uploadImage2D(pageTable, level, TransferFormat::R8G8B8A8_UINT, current.data());
+        swap(parent, current);
+    }
+    pageTableDirty = false;
+}
+
+uint8_t VirtualTexture::getId() const {
+    return id;
+}
+
+Texture2d &VirtualTexture::getPageTable() {
+    return pageTable;
+}
+
+Texture2d &VirtualTexture::getPhysicalCache() {
+    return physicalCache;
+}
+
+VirtualTextureFeedback::VirtualTextureFeedback(OpenGLContext &context, Dimensions2d screenSize) : context(context) {
+    Dimensions2d size(max(1u, screenSize.width / FEEDBACK_DOWNSCALE), max(1u, screenSize.height / FEEDBACK_DOWNSCALE));
+
+    unordered_map<int, unique_ptr<ColorAttachment>> colors;
+    colors[0] = make_unique<OwnedColorTextureAttachment<Texture2d>>(
+            context.buildTexture2D(DataFormat::R8G8B8A8_UINT, size, false),
+            0);
+    unique_ptr<DepthAttachment> depth = make_unique<OwnedDepthRenderbufferAttachment>(
+            context.buildRenderbuffer(size, RenderbufferInternalFormat::D24_UNORM));
+    framebuffer = make_unique<Framebuffer>(context.buildFramebuffer(std::move(colors), make_optional(std::move(depth)), nullopt));
+
+    bytesPerReadback = size_t(size.width) * size.height * 4;
+    GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    readbackBuffer = unique_ptr<UntypedBuffer>(context.buildBuffer(BufferUsage::STREAM_READ,
+        bytesPerReadback * FEEDBACK_READBACK_BUFFERS, flags).onHeap());
+    readbackMemory = static_cast<const uint8_t*>(context.mapPersistentBuffer(*readbackBuffer, flags));
+}
+
+VirtualTextureFeedback::~VirtualTextureFeedback() {
+    for(auto& readback : pending) {
+        context.deleteFence(readback.fence);
+    }
+}
+
+Framebuffer &VirtualTextureFeedback::getFramebuffer() {
+    return *framebuffer;
+}
+
+ClearCommand VirtualTextureFeedback::getClearCommand() {
+    // an alpha of 1.0 is read back as `NO_VIRTUAL_TEXTURE`
+    return ClearCommand(ColorRGBA(0.0f, 0.0f, 0.0f, 1.0f), 1.0f);
+}
+
+float VirtualTextureFeedback::getFeedbackBias() {
+    return -log2(float(FEEDBACK_DOWNSCALE));
+}
+
+void VirtualTextureFeedback::read() {
+    if(pending.size() >= FEEDBACK_READBACK_BUFFERS) {
+        return;
+    }
+    size_t byteOffset = nextReadback * bytesPerReadback;
+    context.readPixelsToBuffer(*framebuffer, *readbackBuffer, byteOffset);
+    pending.push_back(Readback {
+        .fence = context.insertFence(),
+        .byteOffset = byteOffset
+    });
+    nextReadback = (nextReadback + 1) % FEEDBACK_READBACK_BUFFERS;
+}
+
+void VirtualTextureFeedback::dispatch(const vector<VirtualTexture*> &textures) {
+    // only the most recent feedback which has arrived is worth looking at
+    optional<size_t> latest;
+    while(!pending.empty() && context.hasFenceSignalled(pending.front().fence)) {
+        latest = pending.front().byteOffset;
+        context.deleteFence(pending.front().fence);
+        pending.pop_front();
+    }
+    if(!latest) {
+        return;
+    }
+
+    const uint8_t* texel = readbackMemory + *latest;
+    const uint8_t* end = texel + bytesPerReadback;
+    for(; texel != end; texel += 4) {
+        uint8_t id = texel[3];
+        if(id == NO_VIRTUAL_TEXTURE || id >= textures.size() || textures[id] == nullptr) {
+            continue;
+        }
+        textures[id]->request(texel[2], texel[0], texel[1]);
+    }
+}
@@ -0,0 +1,156 @@
+#ifndef GAME_ENGINE_VIRTUAL_TEXTURE_H
+#define GAME_ENGINE_VIRTUAL_TEXTURE_H
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include "../graphics/texturing.h"
+#include "../graphics/OpenGLContext.h"
+#include "texture.h"
+#include "async.h"
+
+using namespace std;
+
+// texels along each side of a page, without its border
+const uint32_t VIRTUAL_PAGE_SIZE = 128;
+// texels copied from the neighbouring pages on each side, so bilinear filtering stays within a page's slot
+const uint32_t VIRTUAL_PAGE_BORDER = 4;
+const uint32_t VIRTUAL_PAGE_SLOT_SIZE = VIRTUAL_PAGE_SIZE + 2 * VIRTUAL_PAGE_BORDER;
+// the page table is RGBA8 and the feedback pass writes page coordinates to an RGBA8 target
+const uint32_t MAX_VIRTUAL_PAGES = 256;
+// the feedback pass renders at 1/8th of the screen's resolution
+const uint32_t FEEDBACK_DOWNSCALE = 8;
+// how many feedback frames may be waiting for the GPU before the pass is skipped
+const uint32_t FEEDBACK_READBACK_BUFFERS = 3;
+// written to the feedback target's alpha channel where no virtual texture is on screen
+const uint8_t NO_VIRTUAL_TEXTURE = 255;
+const uint32_t DEFAULT_MAX_PENDING_PAGE_LOADS = 16;
+
+// writes one page (`VIRTUAL_PAGE_SLOT_SIZE` squared RGBA8 texels, border included) at `level`.
+// runs on a loader thread
+using PageSource = function<void(uint32_t level, uint32_t x, uint32_t y, uint8_t* out)>;
+
+// pages cut from an RGBA image with every mip level, which must be square and `VIRTUAL_PAGE_SIZE` times a power of two.
+// the border wraps around, like the shader's addressing
+PageSource imagePageSource(shared_ptr<const DecodedImage> image);
+
+// a texture which is much larger than what fits in video memory, split into pages.
+// only the pages the feedback pass saw on screen are loaded into a fixed size cache texture,
+// anything else falls back to the closest coarser page which is resident. the coarsest page always is.
+class VirtualTexture {
+    struct Slot {
+        // packed level, x and y, see `pageKey`
+        optional<uint32_t> page;
+        uint64_t lastUsedFrame = 0;
+        // the coarsest page is never evicted
+        bool pinned = false;
+    };
+
+    OpenGLContext& context;
+    AsyncLoader& loader;
+    PageSource source;
+    uint8_t id;
+    uint32_t virtualPages;
+    uint32_t maxLevel;
+    uint32_t physicalPages;
+    uint32_t maxPendingLoads;
+
+    Texture2d physicalCache;
+    Texture2d pageTable;
+    bool pageTableDirty = true;
+
+    vector<Slot> slots;
+    unordered_map<uint32_t, uint32_t> residentPages;
+    unordered_set<uint32_t> loadingPages;
+    // every page requested this frame, along with their ancestors
+    unordered_set<uint32_t> requestedPages;
+    uint64_t frame = 1;
+    // expires along with the texture, so loads which finish afterwards are dropped
+    shared_ptr<bool> alive = make_shared<bool>(true);
+
+    static uint32_t pageKey(uint32_t level, uint32_t x, uint32_t y) {
+        return level << 16 | y << 8 | x;
+    }
+
+    void startLoad(uint32_t page);
+    void pageLoaded(uint32_t page, const vector<uint8_t>& texels);
+    void storePage(uint32_t page, uint32_t slot, const vector<uint8_t>& texels);
+    optional<uint32_t> findFreeSlot();
+    void uploadPageTable();
+
+public:
+    // `id` tells this texture's requests apart in the feedback buffer.
+    // `virtualPages` is the number of pages along each side at level 0, a power of two
+    VirtualTexture(OpenGLContext& context, AsyncLoader& loader, PageSource source, uint8_t id, uint32_t virtualPages,
+                   uint32_t physicalPages, uint32_t maxPendingLoads = DEFAULT_MAX_PENDING_PAGE_LOADS);
+
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    // usually called by `VirtualTextureFeedback::dispatch`
+    void request(uint32_t level, uint32_t x, uint32_t y);
+
+    // must be called on the context thread once per frame, after the requests for that frame.
+    // starts loading missing pages (coarsest first) and updates the page table
+    void update();
+
+    uint8_t getId() const;
+    Texture2d& getPageTable();
+    Texture2d& getPhysicalCache();
+
+    // fills either pipeline's `VirtualTextureBlock`
+    template<typename B>
+    B getBlock(float feedbackBias = 0.0f) const {
+        return B {
+            .virtualPages = float(virtualPages),
+            .maxLevel = float(maxLevel),
+            .pageSize = float(VIRTUAL_PAGE_SIZE),
+            .physicalPages = float(physicalPages),
+            .borderFraction = float(VIRTUAL_PAGE_BORDER) / VIRTUAL_PAGE_SLOT_SIZE,
+            .feedbackBias = feedbackBias,
+            .textureId = float(id)
+        };
+    }
+};
+
+// the feedback pass renders every virtual texture with `vt_feedback` into a small target,
+// which is copied into a persistently mapped buffer and read back a few frames later, without stalling.
+class VirtualTextureFeedback {
+    struct Readback {
+        GLsync fence;
+        size_t byteOffset;
+    };
+
+    OpenGLContext& context;
+    unique_ptr<Framebuffer> framebuffer;
+    unique_ptr<UntypedBuffer> readbackBuffer;
+    const uint8_t* readbackMemory;
+    size_t bytesPerReadback;
+    uint32_t nextReadback = 0;
+    // in the order they were issued, which is the order their fences are signalled in
+    deque<Readback> pending;
+
+public:
+    VirtualTextureFeedback(OpenGLContext& context, Dimensions2d screenSize);
+    ~VirtualTextureFeedback();
+
+    VirtualTextureFeedback(const VirtualTextureFeedback&) = delete;
+    VirtualTextureFeedback& operator=(const VirtualTextureFeedback&) = delete;
+
+    // render the feedback pass into this, after clearing it with `getClearCommand`
+    Framebuffer& getFramebuffer();
+    static ClearCommand getClearCommand();
+    // compensates for the lower resolution, pass it to `VirtualTexture::getBlock`
+    static float getFeedbackBias();
+
+    // queues a copy of this frame's feedback, unless the GPU is too far behind
+    void read();
+
+    // passes the requests from every finished readback to the texture with the matching id
+    void dispatch(const vector<VirtualTexture*>& textures);
+};
+
+#endif //GAME_ENGINE_VIRTUAL_TEXTURE_H
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <map>
 
 #include <glad/glad.h>
 #include <optional>
@@ -15,29 +16,53 @@
 #include "graphics/Shader.h"
 #include "errors.h"
 #include "transform.h"
+#include "transform_array.h"
+#include "scene.h"
+#include "bvh.h"
+#include "occlusion.h"
+#include "jobs.h"
+#include "ecs.h"
+#include "components.h"
 #include "Window.h"
 #include "graphics/OpenGLContext.h"
 #include "graphics/pipeline.h"
 #include "graphics/commands.h"
+#include "graphics/GeometryPool.h"
+#include "graphics/InstanceBatcher.h"
 #include "Camera.h"
 #include "graphics/texturing.h"
 #include "loader/texture.h"
 #include "loader/shaders.h"
 #include "loader/models.h"
+#include "loader/async.h"
+#include "loader/streaming.h"
+#include "loader/upload_queue.h"
+#include "loader/vfs.h"
 
 #include "../gen/shaders/lighting_test.h"
 #include "../gen/shaders/fullscreen.h"
 #include "../gen/shaders/textured.h"
+#include "../gen/shaders/cull_instances.h"
 
 using namespace std;
 
-const char* BUNNY_IMAGE = "/home/chris/code/game_engine/res/textures/LSCM_bunny_texture.png";
-const char* DIAMOND_BLOCK_IMAGE = "/home/chris/code/game_engine/res/textures/Metal_Pattern_004_basecolor.jpg";
-const char* NORMAL_MAP_IMAGE = "/home/chris/code/game_engine/res/textures/Metal_Pattern_004_normal.jpg";
+// asset paths are resolved by the `AssetFileSystem`
+const char* BUNNY_IMAGE = "cooked/LSCM_bunny_texture.ctex";
+const char* DIAMOND_BLOCK_IMAGE = "textures/Metal_Pattern_004_basecolor.jpg";
+const char* NORMAL_MAP_IMAGE = "textures/Metal_Pattern_004_normal.jpg";
+const char* BUNNY_MODEL = "models/LSCM_bunny.obj";
+const char* CUBE_MODEL = "models/cube2/mesh.obj";
 const float MOUSE_SENSITIVITY = 1.5 / 1000.0;
 const float MOVEMENT_SPEED = 0.05f;
 const int NUM_BUNNIES_ROWS = 3;
 const int NUM_BUNNIES_COLUMNS = 3;
+const size_t GEOMETRY_POOL_VERTICES = 1 << 18;
+const size_t GEOMETRY_POOL_INDEX_BYTES = 1 << 22;
+const size_t TEXTURE_STREAMING_BUDGET = 64 * 1024 * 1024;
+const size_t TEXTURE_CACHE_BUDGET = 256 * 1024 * 1024;
+// roughly how far the textures stretch across the models, for picking mip levels
+const float BUNNY_TEXTURE_WORLD_SIZE = 0.4f;
+const float CUBE_TEXTURE_WORLD_SIZE = 2.0f;
 
 struct Uniforms {
 //    char foo[64];
@@ -74,17 +99,20 @@ class Game {
 public:
     Window *window;
     OpenGLContext *context;
+    AsyncLoader *loader;
     ShaderCache *shaderCache;
     Texture2dCache *textureCache;
+    TextureStreamer *textureStreamer;
+    TextureUploadQueue *uploadQueue;
     int frames = 0;
     double time = 0;
     glm::mat4 previousViewProjMatrix = glm::mat4(0);
     Camera *camera;
 
-    ArrayBuffer<uint32_t> *indices;
-    ArrayBuffer<pipelines::lighting_test::VertexInput> *vertices;
+    GeometryPool<pipelines::lighting_test::VertexInput> *geometry;
     //ArrayBuffer<pipelines::lighting_test::VertexInput> *vertices2;
-    ArrayBuffer<pipelines::lighting_test::InstanceInput> *instanceAttrs;
+    // draws every visible renderable, except the bunnies when they're culled on the GPU
+    InstanceBatcher<pipelines::lighting_test::VertexBindings, pipelines::lighting_test::ResourceBindings> *batcher;
     //ArrayBuffer<pipelines::lighting_test::InstanceInput> *instanceAttrs2;
     Buffer<Uniforms> *uniforms;
     Framebuffer *framebuffer;
@@ -92,22 +120,45 @@ public:
     pipelines::textured::Pipeline *texturedPipeline;
     pipelines::fullscreen::Pipeline *quadPipeline;
     pipelines::lighting_test::Pipeline *lightingPipeline;
-
-    vector<Transform> bunnyTransforms;
-    Transform cubeTransform;
+    pipelines::cull_instances::Pipeline *cullingPipeline;
+
+    // every bunny, culled on the GPU into `culledBunnyInstances`, which is then drawn indirectly
+    ArrayBuffer<pipelines::cull_instances::Instance> *allBunnyInstances;
+    ArrayBuffer<pipelines::lighting_test::InstanceInput> *culledBunnyInstances;
+    ArrayBuffer<pipelines::cull_instances::DrawCommand> *bunnyDrawCommands;
+    Buffer<pipelines::cull_instances::CullingBlock> *cullingUniforms;
+
+    TransformArray bunnyTransforms;
+    // over the bunnies' world space bounds, items are indices into `bunnyTransforms`
+    Bvh bunnyBvh;
+    // the entity of each bunny, and its model matrix for this frame, by index into `bunnyTransforms`
+    vector<Entity> bunnyEntities;
+    vector<glm::mat4> bunnyMatrices;
+    OcclusionBuffer occlusion;
+    OccluderMesh cubeOccluder;
+    SceneGraph scene;
+    SceneNode cubeNode;
+    // the CPU side of each frame, rebuilt every frame
+    TaskGraph frameTasks;
     shared_ptr<Texture2d> tex;
-    shared_ptr<Texture2d> diamondTexture;
     shared_ptr<Texture2d> bricksNormalMap;
     Texture2d *bricksNoNormalMap;
 
-    Sampler *linearFiltering;
-    Sampler *linearFilteringWrap;
-    Sampler *nearestFiltering;
+    shared_ptr<Sampler> linearFiltering;
+    shared_ptr<Sampler> linearFilteringWrap;
+    shared_ptr<Sampler> nearestFiltering;
 
+    // shared by every bunny, which are drawn as one instanced batch
     ModelBufferSlices bunnySlices;
-    ModelBufferSlices cubeSlices;
+    BoundingBox bunnyBounds;
+
+    // every bunny and the cube
+    World renderables;
+    Entity cubeEntity;
 
     bool useNormalMap = true;
+    // otherwise bunnies are frustum and occlusion culled on the CPU
+    bool useGpuCulling = true;
 
     ArrayBuffer<pipelines::fullscreen::VertexInput> *fullscreenQuad;
 
@@ -120,8 +171,29 @@ public:
         glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &a);
         LOG_S(ERROR) << "GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT = " << a;
 
-        shaderCache = new ShaderCache(*context);
-        textureCache = new Texture2dCache(*context);
+        // loose files are only used if the archive hasn't been built
+        AssetFileSystem& assets = getAssetFileSystem();
+        assets.mountDirectory(ASSET_DIR);
+        assets.mountDirectory(COOKED_TEXTURE_DIR, "cooked/");
+        if(!assets.mountArchive(ASSET_ARCHIVE)) {
+            LOG_S(WARNING) << "loading loose asset files";
+        }
+
+        // created here so this is its context thread, before the loader's threads start using it
+        getJobSystem();
+        loader = new AsyncLoader();
+        shaderCache = new ShaderCache(*context, *loader);
+        textureCache = new Texture2dCache(*context, *loader, TEXTURE_CACHE_BUDGET);
+        textureStreamer = new TextureStreamer(*context, TEXTURE_STREAMING_BUDGET);
+        uploadQueue = new TextureUploadQueue(*context, *loader);
+
+        // independent assets are decoded concurrently on the loader's threads while the rest of the setup runs here,
+        // only their GL uploads happen on this thread (inside `loader->wait`)
+        AssetFuture<Texture2d> bunnyTexture = textureStreamer->load(*loader, Texture2dMetadata(BUNNY_IMAGE, DesiredTextureFormat::DONT_CARE));
+        AssetFuture<Texture2d> diamondBlockTexture = textureStreamer->load(*loader, Texture2dMetadata(DIAMOND_BLOCK_IMAGE, DesiredTextureFormat::DONT_CARE));
+        AssetFuture<Texture2d> normalMapTexture = uploadQueue->load(Texture2dMetadata(NORMAL_MAP_IMAGE, DesiredTextureFormat::NORMAL_MAP, ColorSpace::LINEAR));
+        AssetFuture<Model> bunnyModel = loader->run([]() { return make_shared<Model>(BUNNY_MODEL); });
+        AssetFuture<Model> cubeModel = loader->run([]() { return make_shared<Model>(CUBE_MODEL); });
 
         window->grabMouseCursor();
 //        window->enterFullscreen();
@@ -152,6 +224,10 @@ public:
                 .depthStencil = DepthStencilState::LESS_THAN_OR_EQUAL_TO,
         }).onHeap();
 
+        cullingPipeline = context->buildPipeline(pipelines::cull_instances::Create {
+                .shaders = shaderCache
+        }).onHeap();
+
         window->setMouseButtonCallback([this](int button, int action, int mods) {
             window->grabMouseCursor();
         });
@@ -173,6 +249,9 @@ public:
             if(key == GLFW_KEY_N) {
                 useNormalMap = !useNormalMap;
             }
+            if(key == GLFW_KEY_G) {
+                useGpuCulling = !useGpuCulling;
+            }
             if(key == GLFW_KEY_ESCAPE) {
                 if(window->isFullscreen()) {
                     window->exitFullscreen();
@@ -188,10 +267,22 @@ public:
             }
         });
 
-        cubeTransform.setPosition(glm::vec3(0.0, 0.0, 2.0));
+        cubeNode = scene.add(NO_PARENT, glm::vec3(0.0, 0.0, 2.0), Transform().getOrientation());
+        for (int i = 0; i < NUM_BUNNIES_ROWS; i++) {
+            for (int j = 0; j < NUM_BUNNIES_COLUMNS; j++) {
+                bunnyTransforms.add(glm::vec3(i - NUM_BUNNIES_ROWS / 2, 0, j - NUM_BUNNIES_COLUMNS / 2),
+                        Transform().getOrientation(), glm::vec3(0.2f));
+            }
+        }
 
-        instanceAttrs = context->buildWritableArrayBuffer<pipelines::lighting_test::InstanceInput>(BufferUsage::DYNAMIC_DRAW,
-                NUM_BUNNIES_ROWS * NUM_BUNNIES_COLUMNS + 1).onHeap();
+        // the culling shader writes the same compact instances the lighting shader reads
+        static_assert(sizeof(pipelines::cull_instances::AffineInstance) == sizeof(pipelines::lighting_test::InstanceInput));
+        allBunnyInstances = context->buildWritableArrayBuffer<pipelines::cull_instances::Instance>(BufferUsage::DYNAMIC_DRAW,
+                NUM_BUNNIES_ROWS * NUM_BUNNIES_COLUMNS).onHeap();
+        culledBunnyInstances = ArrayBuffer<pipelines::lighting_test::InstanceInput>(context->buildBuffer(BufferUsage::DYNAMIC_COPY,
+                sizeof(pipelines::lighting_test::InstanceInput) * NUM_BUNNIES_ROWS * NUM_BUNNIES_COLUMNS, 0)).onHeap();
+        bunnyDrawCommands = context->buildWritableArrayBuffer<pipelines::cull_instances::DrawCommand>(BufferUsage::DYNAMIC_DRAW, 1).onHeap();
+        cullingUniforms = context->buildWritableBuffer<pipelines::cull_instances::CullingBlock>(BufferUsage::DYNAMIC_DRAW).onHeap();
 //        instanceAttrs2 = context->buildWritableArrayBuffer<pipelines::lighting_test::InstanceInput>(BufferUsage::STATIC_DRAW,
 //                1).onHeap();
 
@@ -199,9 +290,9 @@ public:
 
         camera = new Camera(*window, MOUSE_SENSITIVITY, MOVEMENT_SPEED);
 
-        tex = textureCache->get(Texture2dMetadata(BUNNY_IMAGE, DesiredTextureFormat::DONT_CARE));
-        diamondTexture = textureCache->get(Texture2dMetadata(DIAMOND_BLOCK_IMAGE, DesiredTextureFormat::DONT_CARE)); // new Texture2d(create1By1Texture(*context, glm::vec3(0.7f, 0.2f, 0.0f)));
-        bricksNormalMap = textureCache->get(Texture2dMetadata(NORMAL_MAP_IMAGE, DesiredTextureFormat::DONT_CARE));
+        tex = loader->wait(bunnyTexture);
+        shared_ptr<Texture2d> diamondTexture = loader->wait(diamondBlockTexture); // new Texture2d(create1By1Texture(*context, glm::vec3(0.7f, 0.2f, 0.0f)));
+        bricksNormalMap = uploadQueue->wait(normalMapTexture);
         bricksNoNormalMap = new Texture2d(create1By1NormalMap(*context, glm::vec3(0, 0, 1)));
 
         auto depthTex = context->buildTexture2D(DataFormat::D24_UNORM, window->getSize().reduceSize(0), false);
@@ -222,38 +313,44 @@ public:
         GLenum i = GL_COLOR_ATTACHMENT0;
         glDrawBuffers(1, &i);
 
-        linearFiltering = new Sampler(Sampler::build(SamplerCreateInfo::ALL_LINEAR.withAddressMode(SamplerAddressMode::CLAMP_TO_EDGE)));
-        linearFilteringWrap = new Sampler(Sampler::build(SamplerCreateInfo::ALL_LINEAR
+        linearFiltering = context->getSampler(SamplerCreateInfo::ALL_LINEAR.withAddressMode(SamplerAddressMode::CLAMP_TO_EDGE));
+        linearFilteringWrap = context->getSampler(SamplerCreateInfo::ALL_LINEAR
                 .withAddressMode(SamplerAddressMode::REPEAT)
-                .withAnisotropicFiltering(8.0f)));
-        nearestFiltering = new Sampler(Sampler::build(SamplerCreateInfo::ALL_NEAREST));
-
-        auto bunny = Model("/home/chris/code/game_engine/res/models/LSCM_bunny.obj");
-        auto cube = Model("/home/chris/code/game_engine/res/models/cube2/mesh.obj");
-
-        indices = context->buildWritableArrayBuffer<uint32_t>(BufferUsage::STATIC_DRAW, bunny.getNumIndices() + cube.getNumIndices()).onHeap();
-        vertices = context->buildWritableArrayBuffer<pipelines::lighting_test::VertexInput>(BufferUsage::STATIC_DRAW,
-                bunny.getNumVertices() + cube.getNumVertices()).onHeap();
-//        vertices2 = context->buildWritableArrayBuffer<pipelines::lighting_test::VertexInput>(BufferUsage::STATIC_DRAW, cube.getNumVertices()).onHeap();
-
-        context->withMappedBuffer(indices->getSlice(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT,
-                [&bunny, &cube, this](auto indices) {
-                    bunny.writeIndices(indices);
-                    bunnySlices.indices.elementOffset = 0;
-                    bunnySlices.indices.numElements = bunny.getNumIndices();
-                    cube.writeIndices(span(indices.data() + bunny.getNumIndices(), indices.size() - bunny.getNumIndices()));
-                    cubeSlices.indices.elementOffset = 0 + bunnySlices.indices.numElements;
-                    cubeSlices.indices.numElements = cube.getNumIndices();
-                });
-        context->withMappedBuffer(vertices->getSlice(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT,
-                [&bunny, &cube, this](auto vertices) {
-                    bunny.writeVertices(vertices, fillTexturedVertices2);
-                    bunnySlices.vertices.elementOffset = 0;
-                    bunnySlices.vertices.numElements = bunny.getNumVertices();
-                    cube.writeVertices(std::span(vertices.data() + bunny.getNumVertices(), vertices.size() - bunny.getNumVertices()), fillTexturedVertices2);
-                    cubeSlices.vertices.elementOffset = 0 + bunny.getNumVertices();
-                    cubeSlices.vertices.numElements = cube.getNumVertices();
-                });
+                .withAnisotropicFiltering(8.0f));
+        nearestFiltering = context->getSampler(SamplerCreateInfo::ALL_NEAREST);
+
+        shared_ptr<Model> bunny = loader->wait(bunnyModel);
+        shared_ptr<Model> cube = loader->wait(cubeModel);
+
+        geometry = new GeometryPool<pipelines::lighting_test::VertexInput>(*context, GEOMETRY_POOL_VERTICES, GEOMETRY_POOL_INDEX_BYTES);
+        bunnySlices = geometry->upload(*bunny).value();
+        ModelBufferSlices cubeSlices = geometry->upload(*cube).value();
+        batcher = new InstanceBatcher<pipelines::lighting_test::VertexBindings, pipelines::lighting_test::ResourceBindings>(*context, *geometry);
+        bunnyBounds = bunny->getBounds();
+
+        // the cube is simple enough to be its own occluder
+        cubeOccluder.vertices.resize(cube->getNumVertices());
+        cube->writeVertices(span(cubeOccluder.vertices));
+        cubeOccluder.indices.resize(cube->getNumIndices());
+        cube->writeIndices(span(cubeOccluder.indices));
+
+        vector<BoundingBox> bunnyWorldBounds;
+        for(size_t i = 0; i < bunnyTransforms.size(); i++) {
+            bunnyWorldBounds.push_back(bunnyBounds.transform(bunnyTransforms.getModelMatrix(i)));
+        }
+        bunnyBvh.build(bunnyWorldBounds);
+
+        for(size_t i = 0; i < bunnyTransforms.size(); i++) {
+            bunnyEntities.push_back(renderables.create(TransformComponent {}, InstanceComponent { .index = static_cast<uint32_t>(i) },
+                    MeshComponent { .slices = bunnySlices, .localBounds = bunnyBounds },
+                    MaterialComponent { .texture = tex, .textureWorldSize = BUNNY_TEXTURE_WORLD_SIZE },
+                    BoundsComponent {}, LodComponent {}));
+        }
+        bunnyMatrices.resize(bunnyTransforms.size());
+        cubeEntity = renderables.create(TransformComponent {}, SceneNodeComponent { .node = cubeNode },
+                MeshComponent { .slices = cubeSlices, .localBounds = cube->getBounds() },
+                MaterialComponent { .texture = diamondTexture, .textureWorldSize = CUBE_TEXTURE_WORLD_SIZE, .normalMap = bricksNormalMap },
+                BoundsComponent {}, LodComponent {});
 //        context->withMappedBuffer(vertices2->getSlice(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT,
 //                [&cube, this](auto vertices) {
 //
@@ -265,23 +362,70 @@ public:
     }
 
     ~Game() {
-        delete linearFiltering;
-        delete nearestFiltering;
         delete fullscreenQuad;
-        delete vertices;
-        delete linearFilteringWrap;
-        delete indices;
-        delete instanceAttrs;
+        delete batcher;
+        delete geometry;
         delete quadPipeline;
         delete texturedPipeline;
         delete lightingPipeline;
+        linearFiltering.reset();
+        linearFilteringWrap.reset();
+        nearestFiltering.reset();
+        const ResourceCacheStats& textureStats = textureCache->getStats();
+        LOG_S(INFO) << "texture cache: " << textureStats.hits << " hits, " << textureStats.misses << " misses, "
+                    << textureStats.evictions << " evictions, " << textureStats.residentBytes << " bytes resident";
+
         delete shaderCache;
         delete textureCache;
+        delete textureStreamer;
+        // after the loader, whose threads may still be staging textures
+        delete loader;
+        delete uploadQueue;
         delete context;
         delete camera;
         delete window;
     }
 
+    // the culling shader appends every bunny in `frustum` to `culledBunnyInstances` and counts them in the draw command
+    void cullBunniesOnGpu(const Frustum& frustum, const IndexBufferBinding& bunnyIndices) {
+        // composed once per frame by `moveBunnies`
+        context->withMappedBuffer(allBunnyInstances->getSlice(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT, [this](auto instances) {
+            for(size_t i = 0; i < bunnyMatrices.size(); i++) {
+                instances[i].modelMatrix = bunnyMatrices[i];
+            }
+        });
+        context->withMappedBuffer(cullingUniforms->getView(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT, [&, this](auto block) {
+            for(size_t i = 0; i < 6; i++) {
+                block->frustumPlanes[i] = frustum.planes[i];
+            }
+            block->boundsCenter = glm::vec4(bunnyBounds.getCenter(), 0.0f);
+            block->boundsExtent = glm::vec4(bunnyBounds.getExtent(), 0.0f);
+            block->numInstances = bunnyTransforms.size();
+        });
+        context->withMappedBuffer(bunnyDrawCommands->getSlice(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT, [&, this](auto commands) {
+            commands[0] = pipelines::cull_instances::DrawCommand {
+                .count = static_cast<uint32_t>(bunnyIndices.indexCount),
+                .instanceCount = 0,
+                .firstIndex = static_cast<uint32_t>(bunnyIndices.byteOffset / indexFormatGetBytes(bunnyIndices.format)),
+                .baseVertex = static_cast<int>(bunnySlices.vertices.elementOffset),
+                .baseInstance = 0
+            };
+        });
+
+        context->dispatch(pipelines::cull_instances::DispatchCmd {
+                .pipeline = *cullingPipeline,
+                .resourceBindings = {
+                        .cullingBlock = cullingUniforms->getView(),
+                        .allInstances = allBunnyInstances->getSlice(),
+                        .visibleInstances = BufferSlice<pipelines::cull_instances::AffineInstance>(culledBunnyInstances->unsafeGetInner()),
+                        .drawCommands = bunnyDrawCommands->getSlice()
+                },
+                .groupsX = static_cast<GLuint>((bunnyTransforms.size() + pipelines::cull_instances::LOCAL_SIZE_X - 1) / pipelines::cull_instances::LOCAL_SIZE_X)
+        });
+        // the draw reads the command, then the instances as vertex attributes
+        context->memoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    }
+
     void updateUniforms() {
         PointLight light(glm::vec3(-2.5f, 2.5f, -0.5f), glm::vec3(1, 0.7f, 0.5), Attenuation {
                 .constant = 0.01f,
@@ -308,6 +452,9 @@ public:
     }
 
     void onFrame(double delta) {
+        uploadQueue->update();
+        loader->processUploads();
+        getJobSystem().runContextJobs();
         camera->processInput();
 
         time += delta;
@@ -316,28 +463,126 @@ public:
 //
 //        glm::vec3 cameraPos = glm::vec3(floor(camera->getPosition().x), 0.0f, floor(camera->getPosition().z));
 
-        context->withMappedBuffer(instanceAttrs->getSlice(),
-            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT,
-            [this, &delta](auto instances) {
-                int f = 0;
-                for (int i = 0; i < NUM_BUNNIES_ROWS; i++) {
-                    for (int j = 0; j < NUM_BUNNIES_COLUMNS; j++) {
-                        Transform t;
-                        t.setPosition(glm::vec3(i - NUM_BUNNIES_ROWS / 2, 0,
-                                j - NUM_BUNNIES_COLUMNS / 2));
-                        t.setScale(glm::vec3(0.2f));
-                        t.setOrientation(glm::rotate(t.getOrientation(), (float) time / 20.0f,
-                                glm::vec3(0.0f, 1.0f, 0.0f)));
-                        instances[f].modelMatrix = t.getModelMatrix();
-                        instances[f++].normalMatrix = t.getNormalMatrix();
+        glm::vec3 cameraPosition = camera->getPosition();
+        float projectionScale = camera->calculateProjectionMatrix()[1][1];
+        uint32_t screenHeight = window->getSize().height;
+
+        glm::mat4 viewProjection = camera->calculateProjectionMatrix() * camera->calculateViewMatrix();
+        Frustum frustum = Frustum::fromViewProjection(viewProjection);
+
+        // the bunnies and the rest of the scene don't share any state, so they're updated at the same time.
+        // nothing has been submitted for this frame yet, so the GPU is still busy with the last one meanwhile
+        frameTasks.clear();
+        Task moveBunnies = frameTasks.add([&, this]() {
+            glm::quat bunnyOrientation = glm::rotate(Transform().getOrientation(), (float) time / 20.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+            for(size_t i = 0; i < bunnyTransforms.size(); i++) {
+                bunnyTransforms.setRotation(i, bunnyOrientation);
+            }
+            bunnyTransforms.writeModelMatrices(bunnyMatrices);
+            renderables.parallelForEachChunk<TransformComponent, const InstanceComponent>(
+                    [this](span<const Entity> entities, span<TransformComponent> transforms, span<const InstanceComponent> instances) {
+                for(size_t i = 0; i < entities.size(); i++) {
+                    transforms[i].modelMatrix = bunnyMatrices[instances[i].index];
+                }
+            });
+        });
+        Task updateScene = frameTasks.add([&, this]() {
+            scene.update();
+            renderables.each<TransformComponent, const SceneNodeComponent>([this](TransformComponent& transform, const SceneNodeComponent& node) {
+                transform.modelMatrix = scene.getWorldMatrix(node.node);
+            });
+        });
+        Task updateLods = frameTasks.add([&, this]() {
+            renderables.parallelForEachChunk<const TransformComponent, const MeshComponent, const MaterialComponent, BoundsComponent, LodComponent>(
+                    [&](span<const Entity> entities, span<const TransformComponent> transforms, span<const MeshComponent> meshes,
+                            span<const MaterialComponent> materials, span<BoundsComponent> bounds, span<LodComponent> lods) {
+                // instances are culled through the BVH instead, once it's been refit
+                bool isInstanced = renderables.has<InstanceComponent>(entities.front());
+                for(size_t i = 0; i < entities.size(); i++) {
+                    bounds[i].world = meshes[i].localBounds.transform(transforms[i].modelMatrix);
+                    if(!isInstanced) {
+                        lods[i].visible = frustum.intersects(bounds[i].world);
                     }
+                    lods[i].distance = glm::distance(cameraPosition, glm::vec3(transforms[i].modelMatrix[3]));
+                    lods[i].mipLevel = computeDesiredMipLevel(materials[i].texture->size.width, materials[i].textureWorldSize,
+                            lods[i].distance, projectionScale, screenHeight);
                 }
-
-                instances[f].modelMatrix = cubeTransform.getModelMatrix();
-                instances[f].normalMatrix = cubeTransform.getNormalMatrix();
             });
+        });
+        Task refitBvh = frameTasks.add([&, this]() {
+            renderables.each<const BoundsComponent, const InstanceComponent, LodComponent>(
+                    [this](const BoundsComponent& bounds, const InstanceComponent& instance, LodComponent& lod) {
+                bunnyBvh.setBounds(instance.index, bounds.world);
+                lod.visible = false;
+            });
+            bunnyBvh.refit();
+            // whole subtrees inside the frustum are accepted without testing their bunnies one by one
+            bunnyBvh.queryFrustum(frustum, [this](uint32_t i) {
+                renderables.get<LodComponent>(bunnyEntities[i]).visible = true;
+            });
+        });
+        Task renderOccluders = frameTasks.add([&, this]() {
+            occlusion.begin(viewProjection);
+            if(renderables.get<LodComponent>(cubeEntity).visible) {
+                occlusion.addOccluder(cubeOccluder, renderables.get<TransformComponent>(cubeEntity).modelMatrix);
+            }
+            occlusion.render();
+        });
+        frameTasks.precede(moveBunnies, updateLods);
+        frameTasks.precede(updateScene, updateLods);
+        frameTasks.precede(updateLods, refitBvh);
+        frameTasks.precede(updateLods, renderOccluders);
+        frameTasks.submit(getJobSystem());
+        frameTasks.wait(getJobSystem());
+
+        // things out of view don't need their texture streamed in
+        renderables.each<const MaterialComponent, const LodComponent>([this](const MaterialComponent& material, const LodComponent& lod) {
+            if(lod.visible) {
+                textureStreamer->request(*material.texture, lod.mipLevel);
+            }
+        });
 
-//        if(cubeTransform.isDirty()) {
+        IndexBufferBinding bunnyIndices = geometry->getIndexBinding(bunnySlices);
+        if(useGpuCulling) {
+            cullBunniesOnGpu(frustum, bunnyIndices);
+        }
+
+        // renderables sharing a texture share a material, so the batcher can draw them together
+        batcher->clear();
+        map<pair<Texture2d*, Texture2d*>, MaterialId> materialIds;
+        auto getMaterial = [&, this](const MaterialComponent& material) {
+            Texture2d* normalMap = useNormalMap && material.normalMap ? material.normalMap.get() : bricksNoNormalMap;
+            auto [it, inserted] = materialIds.try_emplace(make_pair(material.texture.get(), normalMap), 0);
+            if(inserted) {
+                it->second = batcher->addMaterial(pipelines::lighting_test::ResourceBindings {
+                        .matrixBlock = uniforms->getView().accessField(pipelines::lighting_test::MatrixBlock, matrixBlock),
+                        .material = uniforms->getView().accessField(pipelines::lighting_test::Material, material),
+                        .lightingBlock = uniforms->getView().accessField(pipelines::lighting_test::LightingBlock, lighting),
+                        .materialTexture = material.texture->withSampler(*linearFilteringWrap),
+                        .normalMap = normalMap->withSampler(*linearFilteringWrap)
+                });
+            }
+            return it->second;
+        };
+        renderables.forEachChunk<const TransformComponent, const MeshComponent, const MaterialComponent, const BoundsComponent, const LodComponent>(
+                [&, this](span<const Entity> entities, span<const TransformComponent> transforms, span<const MeshComponent> meshes,
+                        span<const MaterialComponent> materials, span<const BoundsComponent> bounds, span<const LodComponent> lods) {
+            // every entity of a chunk has the same components. instances culled on the GPU are drawn indirectly below
+            if(useGpuCulling && renderables.has<InstanceComponent>(entities.front())) {
+                return;
+            }
+            for(size_t i = 0; i < entities.size(); i++) {
+                if(lods[i].visible && occlusion.isVisible(bounds[i].world)) {
+                    batcher->add(meshes[i].slices, getMaterial(materials[i]), transforms[i].modelMatrix);
+                }
+            }
+        });
+        batcher->upload();
+        OcclusionStats occlusionStats = occlusion.getStats();
+        LOG_S(1) << "occlusion culled " << occlusionStats.culled << " of " << occlusionStats.tested << " instances";
+        textureStreamer->update();
+
+//        if(!scene.getChangedNodes().empty()) {
 //            context->withMappedBuffer(instanceAttrs2->getSlice(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT, [this](auto instances) {
 //
 //            });
@@ -350,42 +595,26 @@ public:
         context->withRenderTarget(*framebuffer, [&](auto guard) {
             guard.clear(ClearCommand(ColorRGBA(0.0f, 0.0f, 0.0f, 1.0), 1.0f));
 
-            guard.draw(pipelines::lighting_test::DrawCmd {
-                    .pipeline = *lightingPipeline,
-                    .vertexBindings = pipelines::lighting_test::VertexBindings {
-                            .perVertex = vertices->getSlice(),
-                            .perInstance = instanceAttrs->getSlice()
-                    },
-                    .resourceBindings = pipelines::lighting_test::ResourceBindings{
-                            .matrixBlock = uniforms->getView().accessField(pipelines::lighting_test::MatrixBlock,
-                                    matrixBlock),
-                            .material = uniforms->getView().accessField(pipelines::lighting_test::Material, material),
-                            .lightingBlock = uniforms->getView().accessField(pipelines::lighting_test::LightingBlock, lighting),
-                            .materialTexture = tex->withSampler(*linearFilteringWrap),
-                            .normalMap = /*useNormalMap ? bricksNormalMap->withSampler(*linearFilteringWrap) :*/ bricksNoNormalMap->withSampler(*linearFilteringWrap)
-                    },
-                    .call = IndexedDrawCall(indices->getSlice().subslice(bunnySlices.indices)),
-                    .instanceCount = NUM_BUNNIES_COLUMNS * NUM_BUNNIES_ROWS,
-                    .firstInstance = 0
-            });
+            if(useGpuCulling) {
+                guard.draw(pipelines::lighting_test::DrawCmd {
+                        .pipeline = *lightingPipeline,
+                        .vertexBindings = pipelines::lighting_test::VertexBindings {
+                                .perVertex = geometry->getVertices(),
+                                .perInstance = culledBunnyInstances->getSlice()
+                        },
+                        .resourceBindings = pipelines::lighting_test::ResourceBindings{
+                                .matrixBlock = uniforms->getView().accessField(pipelines::lighting_test::MatrixBlock,
+                                        matrixBlock),
+                                .material = uniforms->getView().accessField(pipelines::lighting_test::Material, material),
+                                .lightingBlock = uniforms->getView().accessField(pipelines::lighting_test::LightingBlock, lighting),
+                                .materialTexture = tex->withSampler(*linearFilteringWrap),
+                                .normalMap = bricksNoNormalMap->withSampler(*linearFilteringWrap)
+                        },
+                        .call = IndirectIndexedDrawCall(bunnyIndices, bunnyDrawCommands->unsafeGetInner(), 0)
+                });
+            }
 
-            guard.draw(pipelines::lighting_test::DrawCmd {
-                    .pipeline = *lightingPipeline,
-                    .vertexBindings = pipelines::lighting_test::VertexBindings {
-                            .perVertex = vertices->getSlice(),
-                            .perInstance = instanceAttrs->getSlice()
-                    },
-                    .resourceBindings = pipelines::lighting_test::ResourceBindings {
-                            .matrixBlock = uniforms->getView().accessField(pipelines::lighting_test::MatrixBlock,
-                                    matrixBlock),
-                            .material = uniforms->getView().accessField(pipelines::lighting_test::Material, material),
-                            .lightingBlock = uniforms->getView().accessField(pipelines::lighting_test::LightingBlock, lighting),
-                            .materialTexture = diamondTexture->withSampler(*linearFilteringWrap),
-                            .normalMap = useNormalMap ? bricksNormalMap->withSampler(*linearFilteringWrap) : bricksNoNormalMap->withSampler(*linearFilteringWrap)
-                    },
-                    .call = IndexedDrawCall(indices->getSlice().subslice(cubeSlices.indices), cubeSlices.vertices.elementOffset),
-                    .firstInstance = NUM_BUNNIES_COLUMNS * NUM_BUNNIES_ROWS
-            });
+            batcher->draw(guard, *lightingPipeline);
         });
 
         context->withDefaultRenderTarget([&](auto guard) {
@@ -0,0 +1,202 @@
+#include "occlusion.h"
+
+#include <cmath>
+#include <algorithm>
+#include "simd.h"
+#include "parallel.h"
+
+static_assert(OCCLUSION_WIDTH % SIMD_LANES == 0);
+
+// a clip space position in front of the near plane, as pixel coordinates and a [0, 1] depth
+struct ScreenVertex {
+    glm::vec3 position;
+    bool valid;
+};
+
+static ScreenVertex toScreen(const glm::vec4& clip) {
+    if(clip.w <= 0.0f || clip.z < -clip.w) {
+        return ScreenVertex { .valid = false };
+    }
+    glm::vec3 ndc = glm::vec3(clip) / clip.w;
+    return ScreenVertex {
+        .position = glm::vec3((ndc.x * 0.5f + 0.5f) * OCCLUSION_WIDTH, (ndc.y * 0.5f + 0.5f) * OCCLUSION_HEIGHT, ndc.z * 0.5f + 0.5f),
+        .valid = true
+    };
+}
+
+OcclusionBuffer::OcclusionBuffer() {
+    for(uint32_t level = 0; level < OCCLUSION_LEVELS; level++) {
+        levels[level].resize((OCCLUSION_WIDTH >> level) * (OCCLUSION_HEIGHT >> level), 1.0f);
+    }
+}
+
+void OcclusionBuffer::begin(const glm::mat4 &viewProjection) {
+    this->viewProjection = viewProjection;
+    occluders.clear();
+    fill(levels[0].begin(), levels[0].end(), 1.0f);
+    tested = 0;
+    culled = 0;
+}
+
+void OcclusionBuffer::addOccluder(const OccluderMesh &mesh, const glm::mat4 &modelMatrix) {
+    occluders.push_back(Occluder { .mesh = &mesh, .modelViewProjection = viewProjection * modelMatrix });
+}
+
+void OcclusionBuffer::render() {
+    setupTriangles();
+    parallelForRanges(OCCLUSION_HEIGHT, OCCLUSION_ROWS_GRAIN, [this](size_t begin, size_t end) {
+        rasterizeRows(begin, end);
+    });
+    buildHierarchy();
+}
+
+void OcclusionBuffer::setupTriangles() {
+    triangles.clear();
+    vector<ScreenVertex> screenVertices;
+    for(const Occluder& occluder : occluders) {
+        const OccluderMesh& mesh = *occluder.mesh;
+        screenVertices.clear();
+        for(const OccluderVertex& vertex : mesh.vertices) {
+            screenVertices.push_back(toScreen(occluder.modelViewProjection * glm::vec4(vertex.position, 1.0f)));
+        }
+
+        for(size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            const ScreenVertex& v0 = screenVertices[mesh.indices[i]];
+            const ScreenVertex& v1 = screenVertices[mesh.indices[i + 1]];
+            const ScreenVertex& v2 = screenVertices[mesh.indices[i + 2]];
+            // clipping would only make the occluder more accurate, dropping the triangle is still conservative
+            if(!v0.valid || !v1.valid || !v2.valid) {
+                continue;
+            }
+            glm::vec3 p[3] = { v0.position, v1.position, v2.position };
+            float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+            if(abs(area) < 1e-6f) {
+                continue;
+            }
+
+            ScreenTriangle triangle {
+                .depth = max(max(p[0].z, p[1].z), p[2].z),
+                .minX = max(0, int(floor(min(min(p[0].x, p[1].x), p[2].x)))),
+                .maxX = min(int(OCCLUSION_WIDTH) - 1, int(ceil(max(max(p[0].x, p[1].x), p[2].x)))),
+                .minY = max(0, int(floor(min(min(p[0].y, p[1].y), p[2].y)))),
+                .maxY = min(int(OCCLUSION_HEIGHT) - 1, int(ceil(max(max(p[0].y, p[1].y), p[2].y))))
+            };
+            if(triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+                continue;
+            }
+            // either winding, so occluders work whichever way they face
+            float sign = area > 0.0f ? -1.0f : 1.0f;
+            for(int e = 0; e < 3; e++) {
+                glm::vec3 from = p[e], to = p[(e + 1) % 3];
+                float a = sign * (to.y - from.y);
+                float b = -sign * (to.x - from.x);
+                // moved inwards by half a pixel along each axis, so a pixel centre is only inside if the whole
+                // pixel is: an edge function is smallest at one of the pixel's corners
+                float inset = 0.5f * (abs(a) + abs(b));
+                triangle.edges[e] = glm::vec3(a, b, -(a * from.x + b * from.y) - inset);
+            }
+            triangles.push_back(triangle);
+        }
+    }
+}
+
+void OcclusionBuffer::rasterizeRows(uint32_t begin, uint32_t end) {
+    floatN zero = broadcast(0.0f);
+    for(const ScreenTriangle& triangle : triangles) {
+        int firstRow = max<int>(triangle.minY, begin);
+        int lastRow = min<int>(triangle.maxY, end - 1);
+        if(firstRow > lastRow) {
+            continue;
+        }
+        floatN depth = broadcast(triangle.depth);
+        floatN a0 = broadcast(triangle.edges[0].x), a1 = broadcast(triangle.edges[1].x), a2 = broadcast(triangle.edges[2].x);
+        int firstColumn = triangle.minX - triangle.minX % SIMD_LANES;
+
+        for(int y = firstRow; y <= lastRow; y++) {
+            // sampled at pixel centres, against the inset edges
+            float py = y + 0.5f;
+            floatN c0 = broadcast(triangle.edges[0].y * py + triangle.edges[0].z);
+            floatN c1 = broadcast(triangle.edges[1].y * py + triangle.edges[1].z);
+            floatN c2 = broadcast(triangle.edges[2].y * py + triangle.edges[2].z);
+            float* row = levels[0].data() + y * OCCLUSION_WIDTH;
+
+            for(int x = firstColumn; x <= triangle.maxX; x += SIMD_LANES) {
+                floatN px = laneIndices() + broadcast(x + 0.5f);
+                floatN inside = bitAnd(bitAnd(greaterEqual(a0 * px + c0, zero), greaterEqual(a1 * px + c1, zero)),
+                        greaterEqual(a2 * px + c2, zero));
+                floatN current = load(row + x);
+                storeUnaligned(row + x, select(inside, minimum(current, depth), current));
+            }
+        }
+    }
+}
+
+void OcclusionBuffer::buildHierarchy() {
+    for(uint32_t level = 1; level < OCCLUSION_LEVELS; level++) {
+        const vector<float>& source = levels[level - 1];
+        uint32_t sourceWidth = OCCLUSION_WIDTH >> (level - 1);
+        uint32_t width = OCCLUSION_WIDTH >> level;
+        uint32_t height = OCCLUSION_HEIGHT >> level;
+        // the furthest of the four, so a box in front of it is in front of everything it covers
+        for(uint32_t y = 0; y < height; y++) {
+            for(uint32_t x = 0; x < width; x++) {
+                const float* top = &source[2 * y * sourceWidth + 2 * x];
+                const float* bottom = top + sourceWidth;
+                levels[level][y * width + x] = max(max(top[0], top[1]), max(bottom[0], bottom[1]));
+            }
+        }
+    }
+}
+
+bool OcclusionBuffer::isVisible(const BoundingBox &worldBounds) const {
+    tested++;
+
+    glm::vec2 screenMin = glm::vec2(numeric_limits<float>::max());
+    glm::vec2 screenMax = glm::vec2(numeric_limits<float>::lowest());
+    float nearestDepth = numeric_limits<float>::max();
+    for(int corner = 0; corner < 8; corner++) {
+        glm::vec3 position = glm::vec3(
+                corner & 1 ? worldBounds.max.x : worldBounds.min.x,
+                corner & 2 ? worldBounds.max.y : worldBounds.min.y,
+                corner & 4 ? worldBounds.max.z : worldBounds.min.z);
+        ScreenVertex vertex = toScreen(viewProjection * glm::vec4(position, 1.0f));
+        // boxes crossing the near plane are too close to be worth testing
+        if(!vertex.valid) {
+            return true;
+        }
+        screenMin = glm::min(screenMin, glm::vec2(vertex.position));
+        screenMax = glm::max(screenMax, glm::vec2(vertex.position));
+        nearestDepth = min(nearestDepth, vertex.position.z);
+    }
+
+    int minX = max(0, int(floor(screenMin.x)));
+    int maxX = min(int(OCCLUSION_WIDTH) - 1, int(floor(screenMax.x)));
+    int minY = max(0, int(floor(screenMin.y)));
+    int maxY = min(int(OCCLUSION_HEIGHT) - 1, int(floor(screenMax.y)));
+    if(minX > maxX || minY > maxY) {
+        // off screen, which frustum culling deals with
+        return true;
+    }
+
+    // the coarsest level where the box still covers only a few texels on each side
+    uint32_t level = 0;
+    uint32_t size = max(maxX - minX, maxY - minY) + 1;
+    while(level + 1 < OCCLUSION_LEVELS && (size >> level) > 4) {
+        level++;
+    }
+    uint32_t width = OCCLUSION_WIDTH >> level;
+    for(int y = minY >> level; y <= maxY >> level; y++) {
+        for(int x = minX >> level; x <= maxX >> level; x++) {
+            if(nearestDepth <= levels[level][y * width + x]) {
+                return true;
+            }
+        }
+    }
+
+    culled++;
+    return false;
+}
+
+OcclusionStats OcclusionBuffer::getStats() const {
+    return OcclusionStats { .tested = tested, .culled = culled };
+}
@@ -0,0 +1,84 @@
+#ifndef GAME_ENGINE_OCCLUSION_H
+#define GAME_ENGINE_OCCLUSION_H
+
+#include <span>
+#include <atomic>
+#include <vector>
+#include <glm/glm.hpp>
+#include "culling.h"
+
+using namespace std;
+
+// resolution of the software depth buffer. the width must be a multiple of `SIMD_LANES`
+const uint32_t OCCLUSION_WIDTH = 256;
+const uint32_t OCCLUSION_HEIGHT = 128;
+// including the full resolution one, each level halves both sides
+const uint32_t OCCLUSION_LEVELS = 5;
+// below this many rows it isn't worth handing the rasterization to other threads
+const size_t OCCLUSION_ROWS_GRAIN = 16;
+
+// the fast path of `Model::writeVertices` can write these directly
+struct OccluderVertex {
+    glm::vec3 position;
+};
+
+// a closed, simplified mesh (e.g. the low poly version of a wall) which hides what's behind it.
+// it should be smaller than the real one, anything it covers which the real mesh doesn't will be culled
+struct OccluderMesh {
+    vector<OccluderVertex> vertices;
+    vector<uint32_t> indices;
+};
+
+struct OcclusionStats {
+    size_t tested;
+    size_t culled;
+};
+
+// a small depth buffer which occluders are rasterized into on the CPU, then used to test whether bounding
+// boxes are hidden. rasterization is conservative: each triangle only covers the pixels it covers entirely, at
+// the depth of its furthest vertex, and triangles crossing the near plane are dropped, so occluders only ever
+// look further away or smaller than they are. the tests go through a hierarchy holding the furthest depth of each block of pixels.
+class OcclusionBuffer {
+    struct ScreenTriangle {
+        // edge functions a * x + b * y + c, positive inside
+        glm::vec3 edges[3];
+        float depth;
+        int minX, maxX, minY, maxY;
+    };
+
+    struct Occluder {
+        const OccluderMesh* mesh;
+        glm::mat4 modelViewProjection;
+    };
+
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    vector<Occluder> occluders;
+    vector<ScreenTriangle> triangles;
+    // depths from 0 (near) to 1 (far), level 0 is the full resolution buffer
+    vector<float> levels[OCCLUSION_LEVELS];
+
+    mutable atomic<size_t> tested = 0;
+    mutable atomic<size_t> culled = 0;
+
+    void setupTriangles();
+    void rasterizeRows(uint32_t begin, uint32_t end);
+    void buildHierarchy();
+
+public:
+    OcclusionBuffer();
+
+    // starts a new frame, forgetting the occluders and statistics of the previous one
+    void begin(const glm::mat4& viewProjection);
+    // `mesh` must stay alive until `render` returns
+    void addOccluder(const OccluderMesh& mesh, const glm::mat4& modelMatrix);
+    // rasterizes every occluder, split between threads by rows
+    void render();
+
+    // false if the whole box is certainly hidden by occluders. safe to call from many threads after `render`
+    bool isVisible(const BoundingBox& worldBounds) const;
+
+    // tests and culls since `begin`
+    OcclusionStats getStats() const;
+};
+
+#endif //GAME_ENGINE_OCCLUSION_H
@@ -0,0 +1,14 @@
+#ifndef GAME_ENGINE_PARALLEL_H
+#define GAME_ENGINE_PARALLEL_H
+
+#include "jobs.h"
+
+// splits [0, count) into contiguous ranges and calls `callback(begin, end)` for each of them on the
+// engine's job system. ranges are never smaller than `minGrain`, so small inputs just run inline on
+// the calling thread. returns once every range has been processed.
+template<typename F>
+void parallelForRanges(size_t count, size_t minGrain, F callback) {
+    getJobSystem().parallelFor(count, minGrain, callback);
+}
+
+#endif //GAME_ENGINE_PARALLEL_H
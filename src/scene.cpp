@@ -0,0 +1,166 @@
+#include "scene.h"
+
+#include <cassert>
+#include <algorithm>
+#include <glm/gtc/matrix_inverse.hpp>
+
+template<typename T>
+static void permute(vector<T>& values, const vector<uint32_t>& order) {
+    vector<T> sorted;
+    sorted.reserve(values.size());
+    for(uint32_t index : order) {
+        sorted.push_back(values[index]);
+    }
+    values = std::move(sorted);
+}
+
+SceneNode SceneGraph::add(SceneNode parent, glm::vec3 position, glm::quat rotation, glm::vec3 scale) {
+    assert(parent == NO_PARENT || parent < nodeToIndex.size());
+    SceneNode node = nodeToIndex.size();
+    uint32_t index = parents.size();
+
+    uint32_t parentIndex = parent == NO_PARENT ? NO_PARENT : nodeToIndex[parent];
+    uint32_t depth = parent == NO_PARENT ? 0 : depths[parentIndex] + 1;
+    // breadth first, the roots come first and then everything else by its parent's index. appending keeps
+    // that order only if the new node's parent isn't before the last node's, otherwise it has to be moved
+    // back next to its siblings
+    if(index > 0) {
+        bool lastIsRoot = parents.back() == NO_PARENT;
+        bool inOrder = parentIndex == NO_PARENT ? lastIsRoot : lastIsRoot || parentIndex >= parents.back();
+        if(!inOrder) {
+            needsSorting = true;
+        }
+    }
+
+    parents.push_back(parentIndex);
+    depths.push_back(depth);
+    positions.push_back(position);
+    rotations.push_back(rotation);
+    scales.push_back(scale);
+    worldMatrices.push_back(glm::mat4(1.0f));
+    normalMatrices.push_back(glm::mat3(1.0f));
+    dirty.push_back(true);
+    indexToNode.push_back(node);
+    nodeToIndex.push_back(index);
+    return node;
+}
+
+void SceneGraph::sortBreadthFirst() {
+    // a breadth first walk, rather than sorting by depth, so each level follows the order of the one above and
+    // siblings end up next to each other. roots and siblings keep the order they were added in
+    vector<vector<uint32_t>> children(parents.size());
+    vector<uint32_t> order;
+    order.reserve(parents.size());
+    for(uint32_t i = 0; i < parents.size(); i++) {
+        if(parents[i] == NO_PARENT) {
+            order.push_back(i);
+        } else {
+            children[parents[i]].push_back(i);
+        }
+    }
+    for(size_t next = 0; next < order.size(); next++) {
+        for(uint32_t child : children[order[next]]) {
+            order.push_back(child);
+        }
+    }
+
+    vector<uint32_t> newIndex(order.size());
+    for(uint32_t i = 0; i < order.size(); i++) {
+        newIndex[order[i]] = i;
+    }
+    for(uint32_t& parent : parents) {
+        if(parent != NO_PARENT) {
+            parent = newIndex[parent];
+        }
+    }
+
+    permute(parents, order);
+    permute(depths, order);
+    permute(positions, order);
+    permute(rotations, order);
+    permute(scales, order);
+    permute(worldMatrices, order);
+    permute(normalMatrices, order);
+    permute(dirty, order);
+    permute(indexToNode, order);
+    for(uint32_t i = 0; i < indexToNode.size(); i++) {
+        nodeToIndex[indexToNode[i]] = i;
+    }
+    needsSorting = false;
+}
+
+void SceneGraph::setPosition(SceneNode node, glm::vec3 position) {
+    uint32_t index = nodeToIndex[node];
+    positions[index] = position;
+    dirty[index] = true;
+}
+
+void SceneGraph::setRotation(SceneNode node, glm::quat rotation) {
+    uint32_t index = nodeToIndex[node];
+    rotations[index] = rotation;
+    dirty[index] = true;
+}
+
+void SceneGraph::setScale(SceneNode node, glm::vec3 scale) {
+    uint32_t index = nodeToIndex[node];
+    scales[index] = scale;
+    dirty[index] = true;
+}
+
+glm::vec3 SceneGraph::getPosition(SceneNode node) const {
+    return positions[nodeToIndex[node]];
+}
+
+glm::quat SceneGraph::getRotation(SceneNode node) const {
+    return rotations[nodeToIndex[node]];
+}
+
+glm::vec3 SceneGraph::getScale(SceneNode node) const {
+    return scales[nodeToIndex[node]];
+}
+
+SceneNode SceneGraph::getParent(SceneNode node) const {
+    uint32_t parent = parents[nodeToIndex[node]];
+    return parent == NO_PARENT ? NO_PARENT : indexToNode[parent];
+}
+
+const glm::mat4 &SceneGraph::getWorldMatrix(SceneNode node) const {
+    return worldMatrices[nodeToIndex[node]];
+}
+
+const glm::mat3 &SceneGraph::getNormalMatrix(SceneNode node) const {
+    return normalMatrices[nodeToIndex[node]];
+}
+
+void SceneGraph::update() {
+    if(needsSorting) {
+        sortBreadthFirst();
+    }
+
+    changedNodes.clear();
+    // whether the world matrix was recomputed during this pass. parents are always visited first
+    vector<bool> changed(parents.size(), false);
+    for(uint32_t i = 0; i < parents.size(); i++) {
+        uint32_t parent = parents[i];
+        if(!dirty[i] && (parent == NO_PARENT || !changed[parent])) {
+            continue;
+        }
+
+        glm::mat4 local = glm::translate(glm::mat4(1.0f), positions[i]) * glm::toMat4(rotations[i]) * glm::scale(glm::mat4(1.0f), scales[i]);
+        worldMatrices[i] = parent == NO_PARENT ? local : worldMatrices[parent] * local;
+        // a parent's non-uniform scale can skew its children, so this needs the general inverse
+        normalMatrices[i] = glm::inverseTranspose(glm::mat3(worldMatrices[i]));
+
+        dirty[i] = false;
+        changed[i] = true;
+        changedNodes.push_back(indexToNode[i]);
+    }
+}
+
+const vector<SceneNode> &SceneGraph::getChangedNodes() const {
+    return changedNodes;
+}
+
+size_t SceneGraph::size() const {
+    return parents.size();
+}
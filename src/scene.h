@@ -0,0 +1,63 @@
+#ifndef GAME_ENGINE_SCENE_H
+#define GAME_ENGINE_SCENE_H
+
+#include <vector>
+#include <limits>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+using namespace std;
+
+// stays the same while nodes are reordered
+using SceneNode = uint32_t;
+const SceneNode NO_PARENT = numeric_limits<SceneNode>::max();
+
+// a hierarchy of transforms, each relative to its parent.
+// nodes are kept sorted breadth first, so every parent comes before its children and siblings sit next
+// to each other. `update` then recomputes the world matrices of everything that moved (and everything
+// below it) in a single linear pass, and lists which nodes changed, so consumers (instance uploads,
+// culling, shadow caches) only have to look at those.
+class SceneGraph {
+    // indexed by position in the sorted order
+    vector<uint32_t> parents;
+    vector<uint32_t> depths;
+    vector<glm::vec3> positions;
+    vector<glm::quat> rotations;
+    vector<glm::vec3> scales;
+    vector<glm::mat4> worldMatrices;
+    vector<glm::mat3> normalMatrices;
+    // the local transform was changed since the last `update`
+    vector<bool> dirty;
+    vector<SceneNode> indexToNode;
+
+    vector<uint32_t> nodeToIndex;
+    vector<SceneNode> changedNodes;
+    bool needsSorting = false;
+
+    void sortBreadthFirst();
+
+public:
+    // `parent` must already exist. the node's world matrix is only valid after the next `update`
+    SceneNode add(SceneNode parent, glm::vec3 position, glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3 scale = glm::vec3(1.0f));
+
+    void setPosition(SceneNode node, glm::vec3 position);
+    void setRotation(SceneNode node, glm::quat rotation);
+    void setScale(SceneNode node, glm::vec3 scale);
+    glm::vec3 getPosition(SceneNode node) const;
+    glm::quat getRotation(SceneNode node) const;
+    glm::vec3 getScale(SceneNode node) const;
+    SceneNode getParent(SceneNode node) const;
+
+    const glm::mat4& getWorldMatrix(SceneNode node) const;
+    // the inverse transpose of the world matrix's upper 3x3
+    const glm::mat3& getNormalMatrix(SceneNode node) const;
+
+    // recomputes world matrices below every node which was changed since the last call
+    void update();
+    // every node whose world matrix was recomputed by the last `update`, parents before children
+    const vector<SceneNode>& getChangedNodes() const;
+
+    size_t size() const;
+};
+
+#endif //GAME_ENGINE_SCENE_H
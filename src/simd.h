@@ -0,0 +1,45 @@
+#ifndef GAME_ENGINE_SIMD_H
+#define GAME_ENGINE_SIMD_H
+
+#include <cstdint>
+#include <cstddef>
+#include <immintrin.h>
+
+// just enough to write SIMD loops once for both widths, GCC and clang provide the arithmetic operators.
+// masks are vectors with every bit of a lane set or cleared, as returned by the comparisons
+#ifdef __AVX__
+using floatN = __m256;
+const size_t SIMD_LANES = 8;
+static inline floatN load(const float* p) { return _mm256_loadu_ps(p); }
+// `p` must be aligned to the vector size
+static inline void store(float* p, floatN v) { _mm256_store_ps(p, v); }
+static inline void storeUnaligned(float* p, floatN v) { _mm256_storeu_ps(p, v); }
+static inline floatN broadcast(float f) { return _mm256_set1_ps(f); }
+static inline floatN laneIndices() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+static inline floatN absolute(floatN v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+static inline floatN minimum(floatN a, floatN b) { return _mm256_min_ps(a, b); }
+static inline floatN greaterEqual(floatN a, floatN b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static inline floatN bitAnd(floatN a, floatN b) { return _mm256_and_ps(a, b); }
+static inline floatN select(floatN mask, floatN ifSet, floatN ifCleared) { return _mm256_blendv_ps(ifCleared, ifSet, mask); }
+static inline uint32_t laneMask(floatN mask) { return _mm256_movemask_ps(mask); }
+#else
+using floatN = __m128;
+const size_t SIMD_LANES = 4;
+static inline floatN load(const float* p) { return _mm_loadu_ps(p); }
+static inline void store(float* p, floatN v) { _mm_store_ps(p, v); }
+static inline void storeUnaligned(float* p, floatN v) { _mm_storeu_ps(p, v); }
+static inline floatN broadcast(float f) { return _mm_set1_ps(f); }
+static inline floatN laneIndices() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+static inline floatN absolute(floatN v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+static inline floatN minimum(floatN a, floatN b) { return _mm_min_ps(a, b); }
+static inline floatN greaterEqual(floatN a, floatN b) { return _mm_cmpge_ps(a, b); }
+static inline floatN bitAnd(floatN a, floatN b) { return _mm_and_ps(a, b); }
+// no blendv before SSE 4.1
+static inline floatN select(floatN mask, floatN ifSet, floatN ifCleared) { return _mm_or_ps(_mm_and_ps(mask, ifSet), _mm_andnot_ps(mask, ifCleared)); }
+static inline uint32_t laneMask(floatN mask) { return _mm_movemask_ps(mask); }
+#endif
+
+// one bit per lane
+static inline uint32_t nonNegativeLanes(floatN v) { return laneMask(greaterEqual(v, broadcast(0.0f))); }
+
+#endif //GAME_ENGINE_SIMD_H
@@ -17,12 +17,18 @@ public:
         dirty = true;
     }
 
+    glm::vec3 getPosition() const {
+        return position;
+    }
+
     void setScale(glm::vec3 newScale) {
         scale = newScale;
+        dirty = true;
     }
 
     void setOrientation(glm::quat newOrientation) {
         rot = newOrientation;
+        dirty = true;
     }
 
     glm::quat getOrientation() const {
@@ -44,8 +50,13 @@ public:
         return model;
     }
 
+    // the inverse transpose of rotate * scale is just rotate * inverse(scale)
     glm::mat3 getNormalMatrix() {
-        return glm::mat3(glm::transpose(glm::inverse(getModelMatrix())));
+        glm::mat3 normal = glm::toMat3(rot);
+        normal[0] /= scale.x;
+        normal[1] /= scale.y;
+        normal[2] /= scale.z;
+        return normal;
     }
 
 };
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "transform_array.h"
+
+#include "simd.h"
+
+size_t TransformArray::add(glm::vec3 position, glm::quat rotation, glm::vec3 scale) {
+    size_t index = count++;
+    if(index == positionX.size()) {
+        // grows by a whole batch of identity transforms, so `compose` never reads past the end
+        size_t padded = positionX.size() + TRANSFORM_BATCH;
+        for(auto array : { &positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ }) {
+            array->resize(padded, 0.0f);
+        }
+        for(auto array : { &rotationW, &scaleX, &scaleY, &scaleZ }) {
+            array->resize(padded, 1.0f);
+        }
+    }
+    setPosition(index, position);
+    setRotation(index, rotation);
+    setScale(index, scale);
+    return index;
+}
+
+void TransformArray::setPosition(size_t index, glm::vec3 position) {
+    assert(index < count);
+    positionX[index] = position.x;
+    positionY[index] = position.y;
+    positionZ[index] = position.z;
+}
+
+void TransformArray::setRotation(size_t index, glm::quat rotation) {
+    assert(index < count);
+    rotationX[index] = rotation.x;
+    rotationY[index] = rotation.y;
+    rotationZ[index] = rotation.z;
+    rotationW[index] = rotation.w;
+}
+
+void TransformArray::setScale(size_t index, glm::vec3 scale) {
+    assert(index < count);
+    scaleX[index] = scale.x;
+    scaleY[index] = scale.y;
+    scaleZ[index] = scale.z;
+}
+
+glm::vec3 TransformArray::getPosition(size_t index) const {
+    return glm::vec3(positionX[index], positionY[index], positionZ[index]);
+}
+
+glm::quat TransformArray::getRotation(size_t index) const {
+    return glm::quat(rotationW[index], rotationX[index], rotationY[index], rotationZ[index]);
+}
+
+glm::vec3 TransformArray::getScale(size_t index) const {
+    return glm::vec3(scaleX[index], scaleY[index], scaleZ[index]);
+}
+
+glm::mat4 TransformArray::getModelMatrix(size_t index) const {
+    return glm::translate(glm::mat4(1.0f), getPosition(index)) * glm::toMat4(getRotation(index)) * glm::scale(glm::mat4(1.0f), getScale(index));
+}
+
+size_t TransformArray::size() const {
+    return count;
+}
+
+void TransformArray::writeModelMatrices(span<glm::mat4> matrices) const {
+    assert(matrices.size() >= count);
+    size_t numBatches = (count + TRANSFORM_BATCH - 1) / TRANSFORM_BATCH;
+
+    parallelForRanges(numBatches, TRANSFORM_BATCHES_GRAIN, [&](size_t begin, size_t end) {
+        ComposedTransforms batch;
+        for(size_t b = begin; b < end; b++) {
+            size_t first = b * TRANSFORM_BATCH;
+            compose(first, batch);
+
+            size_t lanes = min(TRANSFORM_BATCH, count - first);
+            for(size_t lane = 0; lane < lanes; lane++) {
+                auto m = [&](size_t i) { return batch.model[i][lane]; };
+                matrices[first + lane] = glm::mat4(m(0), m(1), m(2), 0.0f, m(3), m(4), m(5), 0.0f,
+                        m(6), m(7), m(8), 0.0f, m(9), m(10), m(11), 1.0f);
+            }
+        }
+    });
+}
+
+void TransformArray::compose(size_t first, ComposedTransforms &out) const {
+    floatN x = load(&rotationX[first]);
+    floatN y = load(&rotationY[first]);
+    floatN z = load(&rotationZ[first]);
+    floatN w = load(&rotationW[first]);
+    floatN sx = load(&scaleX[first]);
+    floatN sy = load(&scaleY[first]);
+    floatN sz = load(&scaleZ[first]);
+
+    // the rotation matrix of a unit quaternion, same as `glm::toMat4`
+    floatN one = broadcast(1.0f);
+    floatN two = broadcast(2.0f);
+    floatN xx = x * x, yy = y * y, zz = z * z;
+    floatN xy = x * y, xz = x * z, yz = y * z;
+    floatN wx = w * x, wy = w * y, wz = w * z;
+    floatN r00 = one - two * (yy + zz), r01 = two * (xy - wz), r02 = two * (xz + wy);
+    floatN r10 = two * (xy + wz), r11 = one - two * (xx + zz), r12 = two * (yz - wx);
+    floatN r20 = two * (xz - wy), r21 = two * (yz + wx), r22 = one - two * (xx + yy);
+
+    // translate * rotate * scale, so each column of the rotation is scaled by one axis
+    store(out.model[0], r00 * sx);
+    store(out.model[1], r10 * sx);
+    store(out.model[2], r20 * sx);
+    store(out.model[3], r01 * sy);
+    store(out.model[4], r11 * sy);
+    store(out.model[5], r21 * sy);
+    store(out.model[6], r02 * sz);
+    store(out.model[7], r12 * sz);
+    store(out.model[8], r22 * sz);
+    store(out.model[9], load(&positionX[first]));
+    store(out.model[10], load(&positionY[first]));
+    store(out.model[11], load(&positionZ[first]));
+}
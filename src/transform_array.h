@@ -0,0 +1,58 @@
+#ifndef GAME_ENGINE_TRANSFORM_ARRAY_H
+#define GAME_ENGINE_TRANSFORM_ARRAY_H
+
+#include <span>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include "parallel.h"
+
+using namespace std;
+
+// transforms composed per SIMD instruction: 8 with AVX, otherwise 4 with SSE
+#ifdef __AVX__
+const size_t TRANSFORM_BATCH = 8;
+#else
+const size_t TRANSFORM_BATCH = 4;
+#endif
+// below this many batches it isn't worth handing the work to other threads
+const size_t TRANSFORM_BATCHES_GRAIN = 1024;
+
+// model matrices of one batch, one lane per transform
+struct ComposedTransforms {
+    // the upper 3x3 of the model matrix column by column, then the translation
+    alignas(32) float model[12][TRANSFORM_BATCH];
+};
+
+// position, rotation and scale of many objects, stored as structure of arrays so their model matrices
+// can be composed `TRANSFORM_BATCH` at a time. the arrays are padded to a whole batch with identity transforms.
+class TransformArray {
+    vector<float> positionX, positionY, positionZ;
+    vector<float> rotationX, rotationY, rotationZ, rotationW;
+    vector<float> scaleX, scaleY, scaleZ;
+    size_t count = 0;
+
+    // `first` must be a multiple of `TRANSFORM_BATCH`
+    void compose(size_t first, ComposedTransforms& out) const;
+
+public:
+    // returns the new transform's index
+    size_t add(glm::vec3 position, glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3 scale = glm::vec3(1.0f));
+
+    void setPosition(size_t index, glm::vec3 position);
+    void setRotation(size_t index, glm::quat rotation);
+    void setScale(size_t index, glm::vec3 scale);
+    glm::vec3 getPosition(size_t index) const;
+    glm::quat getRotation(size_t index) const;
+    glm::vec3 getScale(size_t index) const;
+    // one at a time, for the odd transform needed outside of `writeModelMatrices`
+    glm::mat4 getModelMatrix(size_t index) const;
+    size_t size() const;
+
+    // the model matrix of every transform, in order, composed in batches
+    void writeModelMatrices(span<glm::mat4> matrices) const;
+};
+
+#endif //GAME_ENGINE_TRANSFORM_ARRAY_H
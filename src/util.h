@@ -6,11 +6,28 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtc/matrix_access.hpp>
+#include <glm/gtc/packing.hpp>
 
 inline glm::vec3 rotatePoint(glm::quat q, glm::vec3 point) {
     return q * point;
 }
 
+// maps a unit vector onto the [-1, 1]^2 square by projecting it onto an octahedron,
+// see "A Survey of Efficient Representations for Independent Unit Vectors" (Cigolle et al.)
+inline glm::vec2 octahedralEncode(glm::vec3 n) {
+    float sum = glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+    if(sum == 0.0f) {
+        return glm::vec2(0.0f);
+    }
+    n /= sum;
+    glm::vec2 e(n.x, n.y);
+    if(n.z < 0.0f) {
+        e = glm::vec2((1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                      (1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+    }
+    return e;
+}
+
 namespace glsl {
     struct mat3 {
         alignas(16) glm::vec3 column0;
@@ -37,13 +54,87 @@ namespace glsl {
             column3 = glm::column(source, 3);
         }
     };
+
+    // compact model matrices for instance inputs, selected by `shader_codegen --instance-transform`. the normal
+    // matrix is rebuilt in the vertex shader, so neither has one.
+
+    // the top three rows of a model matrix, which must be affine. 48 bytes instead of 112
+    struct affine {
+        glm::vec4 row0;
+        glm::vec4 row1;
+        glm::vec4 row2;
+
+        affine(glm::mat4 source) : row0(glm::row(source, 0)), row1(glm::row(source, 1)), row2(glm::row(source, 2)) {}
+    };
+
+    // position, uniform scale and rotation. 32 bytes instead of 112
+    struct trs {
+        // xyz is the position, w the scale
+        glm::vec4 positionScale;
+        // xyzw
+        glm::vec4 rotation;
+
+        trs(glm::vec3 position, glm::quat rotation, float scale)
+            : positionScale(position, scale), rotation(rotation.x, rotation.y, rotation.z, rotation.w) {}
+        // the matrix must only translate, rotate and scale uniformly
+        trs(glm::mat4 source) {
+            float scale = glm::length(glm::vec3(source[0]));
+            glm::quat r = glm::quat_cast(glm::mat3(source) / scale);
+            positionScale = glm::vec4(glm::vec3(source[3]), scale);
+            rotation = glm::vec4(r.x, r.y, r.z, r.w);
+        }
+    };
+
+    // quantized vertex attribute types, selected per attribute by `shader_codegen --quantize`.
+    // each converts from the full-precision glm type, so they can be filled just like a glm::vec*.
+
+    // DataFormat::R16G16_SFLOAT
+    struct half2 {
+        uint32_t bits = 0;
+
+        half2() = default;
+        half2(glm::vec2 source) : bits(glm::packHalf2x16(source)) {}
+    };
+
+    // DataFormat::R16G16B16A16_SFLOAT, also used for vec3s to keep attributes 4-byte aligned
+    struct half4 {
+        uint16_t components[4] = {0, 0, 0, 0};
+
+        half4() = default;
+        half4(glm::vec3 source) : half4(glm::vec4(source, 1.0f)) {}
+        half4(glm::vec4 source) {
+            uint32_t xy = glm::packHalf2x16(glm::vec2(source.x, source.y));
+            uint32_t zw = glm::packHalf2x16(glm::vec2(source.z, source.w));
+            components[0] = xy & 0xFFFF;
+            components[1] = xy >> 16;
+            components[2] = zw & 0xFFFF;
+            components[3] = zw >> 16;
+        }
+    };
+
+    // DataFormat::R16G16_SNORM, a unit vector decoded by `octahedralDecode` in the vertex shader
+    struct octahedral {
+        uint32_t bits = 0;
+
+        octahedral() = default;
+        octahedral(glm::vec3 unitVector) : bits(glm::packSnorm2x16(octahedralEncode(unitVector))) {}
+    };
+
+    // DataFormat::R8G8B8A8_UNORM
+    struct unorm8x4 {
+        uint32_t bits = 0;
+
+        unorm8x4() = default;
+        unorm8x4(glm::vec3 source) : unorm8x4(glm::vec4(source, 1.0f)) {}
+        unorm8x4(glm::vec4 source) : bits(glm::packUnorm4x8(source)) {}
+    };
 }
 
 struct Point2d {
     uint32_t x;
     uint32_t y;
 
-    Point2d(uint32_t x, uint32_t y) : x(x), y(x) {}
+    Point2d(uint32_t x, uint32_t y) : x(x), y(y) {}
 };
 
 struct Dimensions2d {